@@ -0,0 +1,249 @@
+// Host benchmark of the sensor -> decision arithmetic, float (as it was) against Centi.
+//   pio run -e bench && .pio/build/bench/program
+//
+// The host has an FPU and a divider, so its timings understate what both cost on the ATmega2560,
+// where every float operation, every division and every 32 bit multiply is a libgcc call. Both
+// paths are therefore also run with counting number types that report how many of those calls
+// one decision makes.
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include "Fixed.hpp"
+#include "HysteresisQuantizer.hpp"
+#include "SoilSensorState.hpp"
+
+#define BENCH_ITERATIONS 2000000UL
+
+// ---------------------------------------------------------------- counting number types
+
+struct LibCalls
+{
+    unsigned long add, mul, div, cmp, conv; // soft-float
+    unsigned long imul, idiv;               // integer
+    unsigned long total() const { return add + mul + div + cmp + conv + imul + idiv; }
+};
+
+static LibCalls calls;
+
+// Behaves like float, counts what would be a __addsf3/__mulsf3/__divsf3/__cmpsf2/__float*/__fix* call.
+struct CountedFloat
+{
+    float v;
+    CountedFloat(int x) : v(x) { calls.conv++; }
+    CountedFloat(unsigned x) : v(x) { calls.conv++; }
+    CountedFloat(double x) : v(x) {} // literal, folded by the compiler
+    operator short() const { calls.conv++; return (short)v; }
+    CountedFloat operator+(CountedFloat o) const { calls.add++; return raw(v + o.v); }
+    CountedFloat operator-(CountedFloat o) const { calls.add++; return raw(v - o.v); }
+    CountedFloat operator*(CountedFloat o) const { calls.mul++; return raw(v * o.v); }
+    CountedFloat operator/(CountedFloat o) const { calls.div++; return raw(v / o.v); }
+    bool operator<(CountedFloat o) const { calls.cmp++; return v < o.v; }
+    bool operator>(CountedFloat o) const { calls.cmp++; return v > o.v; }
+    static CountedFloat raw(float x) { CountedFloat f(0.0); f.v = x; return f; }
+};
+
+// Behaves like the integer T, counts what would be a __mulsi3 (multiply wider than 16 bit, the
+// MUL instruction covers 8x8, 16 bit products are a few of them inline) or a __udivmod*/__divmod*
+// call (any division or remainder). Sizes are the AVR ones: short 16 bit, long 32 bit.
+template <typename T>
+struct CountedInt
+{
+    T v;
+    CountedInt(T x) : v(x) {}
+    operator T() const { return v; }
+    CountedInt operator+(CountedInt o) const { return v + o.v; }
+    CountedInt operator-(CountedInt o) const { return v - o.v; }
+    CountedInt operator*(CountedInt o) const { if (sizeof(T) > 2) calls.imul++; return v * o.v; }
+    CountedInt operator/(CountedInt o) const { calls.idiv++; return v / o.v; }
+    CountedInt operator%(CountedInt o) const { calls.idiv++; return v % o.v; }
+    CountedInt operator>>(int n) const { return v >> n; }
+};
+
+using Word = CountedInt<unsigned short>;
+using Long = CountedInt<unsigned long>;
+
+// ---------------------------------------------------------------- before: float paths
+
+// SoilSensor::readSensor() scaling followed by its state switch (UNINITIALIZED/MOIST branches)
+template <typename Real>
+static short soilBefore(unsigned short adc, short hys, SoilSensorState& state)
+{
+    short value = ((Real)adc / Real(1023.0)) * Real(500.0);
+    if (state == UNINITIALIZED)
+    {
+        if (value > SOIL_E_DRY - hys) state = SOIL_E_DRY;
+        else if (value > SOIL_DRY - hys) state = SOIL_DRY;
+        else if (value > SOIL_MOIST - hys) state = SOIL_MOIST;
+        else if (value > SOIL_WET - hys) state = SOIL_WET;
+        else state = SOIL_E_WET;
+    }
+    else if (value <= SOIL_E_WET - hys) state = SOIL_E_WET;
+    else if (value <= SOIL_WET - hys) state = SOIL_WET;
+    else if (value >= SOIL_DRY + hys) state = SOIL_DRY;
+    else if (value >= SOIL_E_DRY + hys) state = SOIL_E_DRY;
+    return value;
+}
+
+// Light::update() scaling plus Processor::_lightChanged()
+template <typename Real>
+static bool lightBefore(unsigned short adc, unsigned char threshold, unsigned char hys, bool& active)
+{
+    unsigned short value = (short)(((Real)adc / Real(1023.0)) * Real(500.0));
+    unsigned char level = (short)(Real((int)(value * 100)) / Real(500.0));
+    if (level < threshold - hys) active = true;
+    else if (level > threshold + hys) active = false;
+    return active;
+}
+
+// Processor::_dhtInCahnged() heater and vent decision
+template <typename Real>
+static short dhtBefore(Real temp, Real hum, Real tempOut, Real sp, Real hys, Real humSp, Real humHys, bool& heater)
+{
+    if (heater) { if (temp > sp + hys) heater = false; }
+    else { if (temp < sp - hys) heater = true; }
+    if ((hum > humSp + humHys && tempOut > sp - hys)
+        || (temp > sp + hys && tempOut > sp - hys)
+        || (temp < sp - hys && tempOut > sp + hys))
+        return 1;
+    return 0;
+}
+
+// ---------------------------------------------------------------- after: fixed point paths
+// Templates so the counting run goes through the same expressions; U is unsigned short, L unsigned long.
+
+// SoilSensor::sample(): the reading against the boundaries pre-scaled to readings (SOIL_COUNTS),
+// the quantizer itself is compares and 16 bit adds
+template <typename U>
+static short soilAfter(U raw12, short band, unsigned char& level, bool& valid)
+{
+    if (!valid) level = HysteresisQuantizer<SOIL_LEVELS - 1>::classify(soilThresholdCounts, raw12);
+    else level = HysteresisQuantizer<SOIL_LEVELS - 1>::step(soilThresholdCounts, band, level, raw12);
+    valid = true;
+    return level;
+}
+
+// The first fixed point version, which scaled every reading to V/100 before the quantizer
+static const short soilThresholdsVolts[SOIL_LEVELS - 1] = {230, 270, 310, 350};
+
+template <typename U, typename L>
+static short soilScaled(U raw12, short band, unsigned char& level, bool& valid)
+{
+    short value = (L(raw12) * L(V_REF)) / L(SOIL_ADC_MAX);
+    if (!valid) level = HysteresisQuantizer<SOIL_LEVELS - 1>::classify(soilThresholdsVolts, value);
+    else level = HysteresisQuantizer<SOIL_LEVELS - 1>::step(soilThresholdsVolts, band, level, value);
+    valid = true;
+    return value;
+}
+
+// Light::update() percent (raw * 100 / 4096) plus Processor::_lightChanged()
+template <typename U>
+static bool lightAfter(U raw12, unsigned char threshold, unsigned char hys, unsigned char& level)
+{
+    unsigned char percent = ((raw12 >> 2) * U(25) + U(128)) >> 8;
+    short t = threshold;
+    level = HysteresisQuantizer<1>::step(&t, hys, level, percent);
+    return level == 0;
+}
+
+template <typename C>
+static short dhtAfter(C temp, C hum, C tempOut, C sp, C hys, C humSp, C humHys, bool& heater)
+{
+    if (heater) { if (temp > sp + hys) heater = false; }
+    else { if (temp < sp - hys) heater = true; }
+    if ((hum > humSp + humHys && tempOut > sp - hys)
+        || (temp > sp + hys && tempOut > sp - hys)
+        || (temp < sp - hys && tempOut > sp + hys))
+        return 1;
+    return 0;
+}
+
+// ---------------------------------------------------------------- harness
+
+static volatile unsigned long sink;
+
+template <typename Body>
+static double nsPerCall(Body body)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < BENCH_ITERATIONS; i++) body(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / BENCH_ITERATIONS;
+}
+
+template <typename Body>
+static double libCalls(Body body)
+{
+    calls = {};
+    for (unsigned long i = 0; i < 1000; i++) body(i);
+    return calls.total() / 1000.0;
+}
+
+static void report(const char* name, double before, double after, double callsBefore, double callsAfter)
+{
+    printf("%-14s %10.2f %10.2f %10.1f %10.1f\n", name, before, after, callsBefore, callsAfter);
+}
+
+int main()
+{
+    printf("%-14s %10s %10s %10s %10s\n", "decision", "ns float", "ns fixed", "calls", "calls fix");
+
+    {
+        SoilSensorState state = UNINITIALIZED;
+        unsigned char level = 0;
+        bool valid = false;
+        auto before = [&](unsigned long i) { sink += soilBefore<float>(i & 1023, 10, state); };
+        auto after = [&](unsigned long i) { sink += soilAfter<unsigned short>((i & 1023) << 2, SOIL_COUNTS(10), level, valid); };
+        auto counted = [&](unsigned long i) { sink += soilBefore<CountedFloat>(i & 1023, 10, state); };
+        auto countedAfter = [&](unsigned long i) { sink += soilAfter<Word>((i & 1023) << 2, SOIL_COUNTS(10), level, valid); };
+        report("soil sample", nsPerCall(before), nsPerCall(after), libCalls(counted), libCalls(countedAfter));
+    }
+    {
+        SoilSensorState state = UNINITIALIZED;
+        unsigned char level = 0;
+        bool valid = false;
+        auto before = [&](unsigned long i) { sink += soilBefore<float>(i & 1023, 10, state); };
+        auto after = [&](unsigned long i) { sink += soilScaled<unsigned short, unsigned long>((i & 1023) << 2, 10, level, valid); };
+        auto counted = [&](unsigned long i) { sink += soilBefore<CountedFloat>(i & 1023, 10, state); };
+        auto countedAfter = [&](unsigned long i) { sink += soilScaled<Word, Long>((i & 1023) << 2, 10, level, valid); };
+        report("soil, scaled", nsPerCall(before), nsPerCall(after), libCalls(counted), libCalls(countedAfter));
+    }
+    {
+        bool active = false;
+        unsigned char level = 1;
+        auto before = [&](unsigned long i) { sink += lightBefore<float>(i & 1023, 55, 10, active); };
+        auto after = [&](unsigned long i) { sink += lightAfter<unsigned short>((i & 1023) << 2, 55, 10, level); };
+        auto counted = [&](unsigned long i) { sink += lightBefore<CountedFloat>(i & 1023, 55, 10, active); };
+        auto countedAfter = [&](unsigned long i) { sink += lightAfter<Word>((i & 1023) << 2, 55, 10, level); };
+        report("light sample", nsPerCall(before), nsPerCall(after), libCalls(counted), libCalls(countedAfter));
+    }
+    {
+        bool heater = false;
+        auto before = [&](unsigned long i) {
+            float t = (i % 400) * 0.1f;
+            sink += dhtBefore<float>(t, 60.0f, t - 5.0f, 24.0f, 2.0f, 55.0f, 5.0f, heater);
+        };
+        auto after = [&](unsigned long i) {
+            Centi t = (i % 400) * 10;
+            sink += dhtAfter<Centi>(t, CENTI(60), t - CENTI(5), CENTI(24), CENTI(2), CENTI(55), CENTI(5), heater);
+        };
+        auto counted = [&](unsigned long i) {
+            CountedFloat t = CountedFloat::raw((i % 400) * 0.1f);
+            sink += dhtBefore<CountedFloat>(t, CountedFloat::raw(60), t - CountedFloat::raw(5), CountedFloat::raw(24),
+                                            CountedFloat::raw(2), CountedFloat::raw(55), CountedFloat::raw(5), heater);
+        };
+        auto countedAfter = [&](unsigned long i) {
+            CountedInt<Centi> t = (Centi)((i % 400) * 10);
+            sink += dhtAfter<CountedInt<Centi>>(t, CENTI(60), t - CountedInt<Centi>(CENTI(5)), CENTI(24), CENTI(2), CENTI(55),
+                                                CENTI(5), heater);
+        };
+        report("dht decision", nsPerCall(before), nsPerCall(after), libCalls(counted), libCalls(countedAfter));
+    }
+
+    printf("\ncalls = libgcc calls per decision on the AVR: soft-float operations, divisions and 32 bit\n"
+           "multiplies (each a subroutine of tens to hundreds of cycles, divisions the most).\n"
+           "\"soil, scaled\" is the first fixed point version, one 32 bit multiply and divide per sample.\n");
+    return 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// State of the simulated board shared by the native shim files. The firmware never includes this,
+// it only sees the Arduino API; scenarios drive these values through the script (see SimMain.cpp).
+
+#include <Arduino.h>
+
+#define SIM_I2C_DEVICES 8
+#define SIM_I2C_BYTES 32
+#define SIM_DHT_SENSORS 4
+#define SIM_EEPROM_SIZE 4096
+
+namespace Sim
+{
+    struct I2CDevice
+    {
+        unsigned char address;
+        bool present;
+        unsigned char length;
+        unsigned char data[SIM_I2C_BYTES];
+    };
+
+    struct DHTInput
+    {
+        unsigned char pin;
+        bool present;
+        float temperature;
+        float humidity;
+        unsigned long long released; // us, when the host last ended a start pulse
+    };
+
+    // DS1302 on three pins, only the clock burst read is answered
+    struct RTCClock
+    {
+        bool present;
+        unsigned char sclk;
+        unsigned char io;
+        unsigned char ce;
+        long long epoch;            // s, time set by the script ...
+        unsigned long long setAt;   // us, ... at this firmware time
+        unsigned char bit;
+        unsigned char command;
+        bool reading;
+        unsigned char data[8];
+    };
+
+    struct Stats
+    {
+        unsigned long loops;
+        unsigned long pinWrites;
+        unsigned long analogReads;
+        unsigned long i2cRequests;
+        unsigned long framesDrawn;
+        unsigned long pagesDrawn;
+        unsigned long contrastWrites;
+        unsigned long eepromWrites;
+        unsigned long eepromStallUs; // time spent waiting for a previous EEPROM write
+        unsigned long httpRequests;
+        unsigned long httpBytes;
+        unsigned long allocations;
+        long heapBytes;
+        long heapPeak;
+    };
+
+    extern bool trace;
+    extern Stats stats;
+
+    // with the virtual clock time only moves through delay() and advanceTo()
+    extern bool virtualClock;
+    void advanceTo(unsigned long long us);
+
+    extern unsigned char pinModes[NUM_DIGITAL_PINS];
+    extern unsigned char pinLevels[NUM_DIGITAL_PINS];
+    extern unsigned short analogValues[NUM_DIGITAL_PINS];
+    extern I2CDevice i2cDevices[SIM_I2C_DEVICES];
+    extern DHTInput dhtInputs[SIM_DHT_SENSORS];
+    extern RTCClock rtcClock;
+
+    extern unsigned char eeprom[SIM_EEPROM_SIZE];
+    extern long eepromStuck; // address whose writes do not stick, -1 for none
+    bool loadEeprom(const char* path);
+    bool saveEeprom(const char* path);
+
+    extern bool wifiPresent;
+    extern bool wifiUp;
+    extern bool serverUp;
+
+    void setDigitalInput(unsigned char pin, unsigned char level);
+    I2CDevice* i2cDevice(unsigned char address, bool create);
+    DHTInput* dhtInput(unsigned char pin, bool create);
+    unsigned char dhtLevel(const DHTInput* dht, unsigned long long us);
+    void rtcPinWritten(unsigned char pin, unsigned char previous);
+    void serialInject(const char* line);
+    void espWrite(unsigned char c);
+    int espAvailable();
+    int espRead();
+    int espPeek();
+
+    void* allocate(size_t size);
+    void* reallocate(void* ptr, size_t size);
+    void release(void* ptr);
+}
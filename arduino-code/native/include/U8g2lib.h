@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Display stand-in: draws nothing, counts frames and pages so render cost can be compared.
+
+#define U8G2_SIM_PAGES 12 // 96 rows / 8 rows per page with the _1_ page buffer
+// Virtual time one page costs on the Mega: drawing into the 1 kB buffer plus 512 B of 4-bit pixels
+// at 8 MHz SPI. A rough figure, only there so the scheduler statistics see the display at all.
+#define U8G2_SIM_PAGE_US 1500
+
+struct u8g2_cb_t { unsigned char rotation; };
+static const u8g2_cb_t U8G2_R0_cb = {0};
+#define U8G2_R0 (&U8G2_R0_cb)
+
+static const uint8_t u8g2_font_helvB08_tr[1] = {8};
+static const uint8_t u8g2_font_helvB10_tr[1] = {10};
+static const uint8_t u8g2_font_helvR08_tr[1] = {8};
+static const uint8_t u8g2_font_ncenB10_tr[1] = {10};
+static const uint8_t u8g2_font_ncenB12_tr[1] = {12};
+static const uint8_t u8g2_font_ncenB18_tr[1] = {18};
+static const uint8_t u8g2_font_logisoso24_tr[1] = {24};
+static const uint8_t u8g2_font_u8glib_4_tf[1] = {4};
+
+class U8G2 : public Print
+{
+private:
+    unsigned char _page = 0;
+    unsigned char _font_width = 6;
+    unsigned char _contrast = 0;
+
+public:
+    void begin() {}
+    void setContrast(unsigned char value);
+    void setFont(const uint8_t* font) { _font_width = (font[0] * 3) / 4; }
+    void setDrawColor(unsigned char color) { (void)color; }
+    void setCursor(int x, int y) { (void)x; (void)y; }
+
+    void firstPage();
+    unsigned char nextPage();
+    unsigned char getPageCount() { return U8G2_SIM_PAGES; }
+
+    int getStrWidth(const char* str) { return strlen(str) * _font_width; }
+    void drawStr(int x, int y, const char* str) { (void)x; (void)y; (void)str; }
+    void drawFrame(int x, int y, int w, int h) { (void)x; (void)y; (void)w; (void)h; }
+    void drawBox(int x, int y, int w, int h) { (void)x; (void)y; (void)w; (void)h; }
+    void drawLine(int x0, int y0, int x1, int y1) { (void)x0; (void)y0; (void)x1; (void)y1; }
+
+    size_t write(uint8_t c) override { (void)c; return 1; }
+    using Print::write;
+};
+
+class U8G2_SSD1327_VISIONOX_128X96_1_4W_HW_SPI : public U8G2
+{
+public:
+    U8G2_SSD1327_VISIONOX_128X96_1_4W_HW_SPI(const u8g2_cb_t* rotation, unsigned char cs, unsigned char dc, unsigned char reset)
+    {
+        (void)rotation; (void)cs; (void)dc; (void)reset;
+    }
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+
+enum wl_status_t
+{
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED
+};
+
+// time the library blocks in its AT command exchanges, or the module takes to answer a raw one
+#define SIM_WIFI_PROBE_MS 5000          // init() retrying "AT" on a missing module
+#define SIM_WIFI_INIT_MS 3300           // init(), AT+RST with its 3 s wait and the setup commands
+#define SIM_WIFI_JOIN_MS 2500           // begin() or a raw AT+CWJAP_CUR, access point answers
+#define SIM_WIFI_JOIN_FAIL_MS 15000     // begin() or a raw AT+CWJAP_CUR ending in FAIL
+#define SIM_ESP_AT_MS 5                 // answer to a short raw AT command on Serial1
+#define SIM_WIFI_CONNECT_MS 120         // AT+CIPSTART to a LAN host
+#define SIM_WIFI_CONNECT_FAIL_MS 5000   // AT+CIPSTART to a host that does not answer, ERROR after the TCP retries
+#define SIM_WIFI_SEND_US 12000          // AT+CIPSEND, from the last data byte to SEND OK
+#define SIM_WIFI_BYTE_US 87             // one byte on Serial1 at 115200 baud
+#define SIM_ESP_TX_BUFFER 64            // bytes HardwareSerial queues before write() waits
+#define SIM_WIFI_CLOSE_MS 20            // AT+CIPCLOSE
+
+// Link state comes from the script ("wifi up|down|missing", "server up|down").
+// The firmware talks TCP through raw AT commands, see Sim::espWrite().
+class WiFiEspClass
+{
+public:
+    void init(Stream* espSerial);
+    unsigned char status();
+    int begin(const char* ssid, const char* pass);
+    IPAddress localIP();
+};
+
+extern WiFiEspClass WiFi;
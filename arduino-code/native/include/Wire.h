@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define WIRE_BUFFER_LENGTH 32
+
+class TwoWire : public Stream
+{
+private:
+    unsigned char _rx[WIRE_BUFFER_LENGTH];
+    unsigned char _rx_len = 0;
+    unsigned char _rx_pos = 0;
+    unsigned char _tx_address = 0;
+
+public:
+    void begin() {}
+    unsigned char requestFrom(int address, int quantity);
+    void beginTransmission(int address) { _tx_address = address; }
+    unsigned char endTransmission();
+    size_t write(uint8_t c) override { (void)c; return 1; }
+    using Print::write;
+    int available() override { return _rx_len - _rx_pos; }
+    int read() override { return (_rx_pos < _rx_len) ? _rx[_rx_pos++] : -1; }
+    int peek() override { return (_rx_pos < _rx_len) ? _rx[_rx_pos] : -1; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,19 @@
+#pragma once
+
+// ATmega2560 data EEPROM backed by Sim::eeprom. A byte write keeps the EEPROM busy for
+// SIM_EEPROM_WRITE_US, writing again before that stalls the caller like the real busy-wait does.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define E2END 0x0FFF
+#define SIM_EEPROM_WRITE_US 3400 // erase + write of one byte
+
+#define eeprom_is_ready() sim_eeprom_is_ready()
+#define eeprom_busy_wait() do {} while (!eeprom_is_ready())
+
+bool sim_eeprom_is_ready();
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_write_byte(uint8_t* addr, uint8_t value);
+void eeprom_update_byte(uint8_t* addr, uint8_t value);
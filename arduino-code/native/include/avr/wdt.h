@@ -0,0 +1,10 @@
+#pragma once
+
+#define WDTO_15MS 0
+#define WDTO_1S 6
+#define WDTO_2S 7
+#define WDTO_8S 9
+
+inline void wdt_enable(unsigned char timeout) { (void)timeout; }
+inline void wdt_disable() {}
+inline void wdt_reset() {}
@@ -0,0 +1,384 @@
+// Arduino core replacement for the native build: time, pins, interrupts, Serial, Print and String.
+
+#include <Arduino.h>
+#include <Sim.h>
+
+#include <chrono>
+#include <cstdio>
+#include <new>
+#include <thread>
+
+namespace Sim
+{
+    bool trace = false;
+    Stats stats = {};
+    bool virtualClock = false;
+
+    unsigned char pinModes[NUM_DIGITAL_PINS] = {0};
+    unsigned char pinLevels[NUM_DIGITAL_PINS] = {0};
+    unsigned short analogValues[NUM_DIGITAL_PINS] = {0};
+
+    static void (*isrHandlers[6])() = {nullptr};
+    static int isrModes[6] = {0};
+
+    static char serialRx[256];
+    static unsigned short serialRxHead = 0;
+    static unsigned short serialRxTail = 0;
+}
+
+// ---------------------------------------------------------------- time
+
+static const std::chrono::steady_clock::time_point simStart = std::chrono::steady_clock::now();
+static unsigned long long simNowUs = 0;
+
+// 64 bit so a week long run does not depend on the firmware's own wrap handling
+static unsigned long long simMicros()
+{
+    if (Sim::virtualClock) return simNowUs;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - simStart).count();
+}
+
+void Sim::advanceTo(unsigned long long us)
+{
+    if (virtualClock && us > simNowUs) simNowUs = us;
+}
+
+unsigned long micros() { return (unsigned long)simMicros(); }
+
+unsigned long millis() { return (unsigned long)(simMicros() / 1000); }
+
+void delay(unsigned long ms)
+{
+    if (Sim::virtualClock) simNowUs += 1000ULL * ms;
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (Sim::virtualClock) simNowUs += us;
+    else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ---------------------------------------------------------------- pins
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= NUM_DIGITAL_PINS) return;
+    // releasing a line held low is the end of a DHT11 start pulse, the sensor answers from here
+    if (Sim::pinModes[pin] == OUTPUT && mode != OUTPUT && !Sim::pinLevels[pin])
+    {
+        Sim::DHTInput* dht = Sim::dhtInput(pin, false);
+        if (dht) dht->released = simMicros();
+    }
+    Sim::pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) Sim::pinLevels[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin >= NUM_DIGITAL_PINS) return;
+    val = val ? HIGH : LOW;
+    Sim::stats.pinWrites++;
+    if (Sim::pinLevels[pin] != val && Sim::trace && Sim::pinModes[pin] == OUTPUT)
+        printf("# %lu pin %u -> %u\n", millis(), pin, val);
+    unsigned char previous = Sim::pinLevels[pin];
+    Sim::pinLevels[pin] = val;
+    if (Sim::rtcClock.present) Sim::rtcPinWritten(pin, previous);
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= NUM_DIGITAL_PINS) return LOW;
+    // a read costs time, otherwise a busy wait on the virtual clock would never end
+    if (Sim::virtualClock) simNowUs++;
+    Sim::DHTInput* dht = (Sim::pinModes[pin] != OUTPUT) ? Sim::dhtInput(pin, false) : nullptr;
+    if (dht && dht->released) return Sim::dhtLevel(dht, simMicros() - dht->released);
+    return Sim::pinLevels[pin];
+}
+
+int analogRead(uint8_t pin)
+{
+    if (pin < A0) pin += A0;
+    Sim::stats.analogReads++;
+    return (pin < NUM_DIGITAL_PINS) ? Sim::analogValues[pin] : 0;
+}
+
+// ---------------------------------------------------------------- interrupts
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+    switch (pin)
+    {
+        case 2: return 0;
+        case 3: return 1;
+        case 21: return 2;
+        case 20: return 3;
+        case 19: return 4;
+        case 18: return 5;
+        default: return NOT_AN_INTERRUPT;
+    }
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode)
+{
+    if (interrupt >= 6) return;
+    Sim::isrHandlers[interrupt] = isr;
+    Sim::isrModes[interrupt] = mode;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    if (interrupt < 6) Sim::isrHandlers[interrupt] = nullptr;
+}
+
+// Drives an input pin from the script and fires the attached interrupt like the hardware would.
+void Sim::setDigitalInput(unsigned char pin, unsigned char level)
+{
+    if (pin >= NUM_DIGITAL_PINS) return;
+    unsigned char old = pinLevels[pin];
+    pinLevels[pin] = level ? HIGH : LOW;
+    int interrupt = digitalPinToInterrupt(pin);
+    if (interrupt == NOT_AN_INTERRUPT || !isrHandlers[interrupt] || old == pinLevels[pin]) return;
+    int mode = isrModes[interrupt];
+    if (mode == CHANGE || (mode == FALLING && !pinLevels[pin]) || (mode == RISING && pinLevels[pin]))
+        isrHandlers[interrupt]();
+}
+
+// ---------------------------------------------------------------- heap accounting
+
+// Every block carries its size so frees can be subtracted, mirroring what malloc costs on the AVR.
+void* Sim::allocate(size_t size)
+{
+    size_t* block = (size_t*)malloc(size + sizeof(size_t));
+    if (!block) return nullptr;
+    *block = size;
+    stats.allocations++;
+    stats.heapBytes += size;
+    if (stats.heapBytes > stats.heapPeak) stats.heapPeak = stats.heapBytes;
+    return block + 1;
+}
+
+void* Sim::reallocate(void* ptr, size_t size)
+{
+    if (!ptr) return allocate(size);
+    size_t* block = (size_t*)ptr - 1;
+    size_t old = *block;
+    block = (size_t*)realloc(block, size + sizeof(size_t));
+    if (!block) return nullptr;
+    *block = size;
+    stats.allocations++;
+    stats.heapBytes += (long)size - (long)old;
+    if (stats.heapBytes > stats.heapPeak) stats.heapPeak = stats.heapBytes;
+    return block + 1;
+}
+
+void Sim::release(void* ptr)
+{
+    if (!ptr) return;
+    size_t* block = (size_t*)ptr - 1;
+    stats.heapBytes -= *block;
+    free(block);
+}
+
+void* operator new(size_t size)
+{
+    void* ptr = Sim::allocate(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { Sim::release(ptr); }
+void operator delete[](void* ptr) noexcept { Sim::release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Sim::release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Sim::release(ptr); }
+
+// ---------------------------------------------------------------- Print
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::_printNumber(unsigned long n, uint8_t base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2) base = 10;
+    do
+    {
+        char c = n % base;
+        n /= base;
+        *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (n);
+    return write(str);
+}
+
+size_t Print::_printFloat(double number, uint8_t digits)
+{
+    if (isnan(number)) return print("nan");
+    if (isinf(number)) return print("inf");
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, number);
+    return write(buf);
+}
+
+size_t Print::print(const __FlashStringHelper* str) { return write(reinterpret_cast<const char*>(str)); }
+size_t Print::print(const String& str) { return write((const uint8_t*)str.c_str(), str.length()); }
+size_t Print::print(const char* str) { return write(str); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char n, int base) { return _printNumber(n, base); }
+size_t Print::print(unsigned int n, int base) { return _printNumber(n, base); }
+size_t Print::print(unsigned long n, int base) { return _printNumber(n, base); }
+size_t Print::print(int n, int base) { return print((long)n, base); }
+
+size_t Print::print(long n, int base)
+{
+    if (base == 10 && n < 0) return print('-') + _printNumber(-n, 10);
+    return _printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) { return _printFloat(n, digits); }
+size_t Print::print(const Printable& p) { return p.printTo(*this); }
+size_t Print::println() { return write("\r\n"); }
+
+size_t IPAddress::printTo(Print& p) const
+{
+    size_t n = 0;
+    for (unsigned char i = 0; i < 4; i++)
+    {
+        if (i) n += p.print('.');
+        n += p.print(_octets[i], DEC);
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------- Serial
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (_port != 0) // Serial1 is the ESP link
+    {
+        Sim::espWrite(c);
+        return 1;
+    }
+    if (c != '\r') putchar(c);
+    return 1;
+}
+
+int HardwareSerial::available()
+{
+    if (_port != 0) return Sim::espAvailable();
+    return (Sim::serialRxHead - Sim::serialRxTail + sizeof(Sim::serialRx)) % sizeof(Sim::serialRx);
+}
+
+int HardwareSerial::read()
+{
+    if (_port != 0) return Sim::espRead();
+    if (!available()) return -1;
+    char c = Sim::serialRx[Sim::serialRxTail];
+    Sim::serialRxTail = (Sim::serialRxTail + 1) % sizeof(Sim::serialRx);
+    return c;
+}
+
+int HardwareSerial::peek()
+{
+    if (_port != 0) return Sim::espPeek();
+    return available() ? Sim::serialRx[Sim::serialRxTail] : -1;
+}
+
+void Sim::serialInject(const char* line)
+{
+    for (const char* c = line; ; c++)
+    {
+        unsigned short next = (serialRxHead + 1) % sizeof(serialRx);
+        if (next == serialRxTail) return;
+        serialRx[serialRxHead] = *c ? *c : '\n';
+        serialRxHead = next;
+        if (!*c) return;
+    }
+}
+
+// ---------------------------------------------------------------- String
+
+void String::_assign(const char* str, unsigned int len)
+{
+    char* buffer = (char*)Sim::reallocate(_buffer, len + 1);
+    if (!buffer) return;
+    _buffer = buffer;
+    memcpy(_buffer, str, len);
+    _buffer[len] = '\0';
+    _len = len;
+}
+
+void String::_append(const char* str, unsigned int len)
+{
+    char* buffer = (char*)Sim::reallocate(_buffer, _len + len + 1);
+    if (!buffer) return;
+    _buffer = buffer;
+    memmove(_buffer + _len, str, len);
+    _len += len;
+    _buffer[_len] = '\0';
+}
+
+String::String(const char* str) { _assign(str ? str : "", str ? strlen(str) : 0); }
+String::String(const String& other) { _assign(other.c_str(), other._len); }
+String::String(char c) { _assign(&c, 1); }
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base)
+{
+    char buf[34];
+    if (base == 10) snprintf(buf, sizeof(buf), "%ld", value);
+    else if (base == 16) snprintf(buf, sizeof(buf), "%lx", value);
+    else snprintf(buf, sizeof(buf), "%lo", value);
+    _assign(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+    char buf[34];
+    if (base == 16) snprintf(buf, sizeof(buf), "%lx", value);
+    else snprintf(buf, sizeof(buf), "%lu", value);
+    _assign(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned char decimals)
+{
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    _assign(buf, strlen(buf));
+}
+
+String::~String() { Sim::release(_buffer); }
+
+String& String::operator=(const String& other)
+{
+    if (this != &other) _assign(other.c_str(), other._len);
+    return *this;
+}
+
+String& String::operator=(const char* str)
+{
+    _assign(str ? str : "", str ? strlen(str) : 0);
+    return *this;
+}
+
+String& String::operator+=(const String& other) { _append(other.c_str(), other._len); return *this; }
+String& String::operator+=(const char* str) { if (str) _append(str, strlen(str)); return *this; }
+String& String::operator+=(char c) { _append(&c, 1); return *this; }
+
+String operator+(const String& lhs, const String& rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String& lhs, const char* rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const char* lhs, const String& rhs) { String s(lhs); s += rhs; return s; }
@@ -0,0 +1,425 @@
+// Stand-ins for the external libraries (Wire, U8g2, WiFiEsp), the DHT11 line and the EEPROM, backed by the scripted board state.
+
+#include <Arduino.h>
+#include <Sim.h>
+#include <Wire.h>
+#include <U8g2lib.h>
+#include <WiFiEsp.h>
+#include <avr/eeprom.h>
+
+#include <cstdio>
+#include <ctime>
+
+namespace Sim
+{
+    I2CDevice i2cDevices[SIM_I2C_DEVICES] = {};
+    DHTInput dhtInputs[SIM_DHT_SENSORS] = {};
+    RTCClock rtcClock = {};
+    unsigned char eeprom[SIM_EEPROM_SIZE];
+    long eepromStuck = -1;
+
+    bool wifiPresent = true;
+    bool wifiUp = true;
+    bool serverUp = true;
+}
+
+Sim::I2CDevice* Sim::i2cDevice(unsigned char address, bool create)
+{
+    for (I2CDevice& dev : i2cDevices)
+        if (dev.length && dev.address == address) return &dev;
+    if (!create) return nullptr;
+    for (I2CDevice& dev : i2cDevices)
+        if (!dev.length)
+        {
+            dev.address = address;
+            dev.present = true;
+            dev.length = SIM_I2C_BYTES;
+            memset(dev.data, 0, sizeof(dev.data));
+            return &dev;
+        }
+    return nullptr;
+}
+
+Sim::DHTInput* Sim::dhtInput(unsigned char pin, bool create)
+{
+    for (DHTInput& dht : dhtInputs)
+        if (dht.pin == pin && (dht.present || create)) return &dht;
+    if (!create) return nullptr;
+    for (DHTInput& dht : dhtInputs)
+        if (!dht.pin)
+        {
+            dht.pin = pin;
+            return &dht;
+        }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------- Wire
+
+TwoWire Wire;
+
+// Unscripted addresses answer with zeros so an unmodified firmware keeps running,
+// "i2c <addr> off" removes the device and the request comes back empty.
+unsigned char TwoWire::requestFrom(int address, int quantity)
+{
+    Sim::stats.i2cRequests++;
+    _rx_pos = 0;
+    _rx_len = 0;
+    Sim::I2CDevice* dev = Sim::i2cDevice(address, false);
+    if (dev && !dev->present) return 0;
+    if (quantity > WIRE_BUFFER_LENGTH) quantity = WIRE_BUFFER_LENGTH;
+    for (int i = 0; i < quantity; i++) _rx[i] = (dev && i < SIM_I2C_BYTES) ? dev->data[i] : 0;
+    _rx_len = quantity;
+    return quantity;
+}
+
+unsigned char TwoWire::endTransmission()
+{
+    Sim::I2CDevice* dev = Sim::i2cDevice(_tx_address, false);
+    return (dev && !dev->present) ? 2 : 0;
+}
+
+// ---------------------------------------------------------------- DHT
+
+// Level of the data line `us` after the host released it: 30 us pull-up, 80 us low, 80 us high,
+// then 40 bits of 50 us low + 27 us (0) or 70 us (1) high, 50 us low and idle high again.
+unsigned char Sim::dhtLevel(const DHTInput* dht, unsigned long long us)
+{
+    if (us < 30) return HIGH;
+    if (us < 110) return LOW;
+    if (us < 190) return HIGH;
+    us -= 190;
+
+    float temperature = dht->temperature < 0 ? -dht->temperature : dht->temperature;
+    unsigned char data[5];
+    data[0] = (unsigned char)dht->humidity;
+    data[1] = (unsigned char)((dht->humidity - data[0]) * 10 + 0.5f);
+    data[2] = (unsigned char)temperature;
+    data[3] = (unsigned char)((temperature - data[2]) * 10 + 0.5f) | (dht->temperature < 0 ? 0x80 : 0);
+    data[4] = data[0] + data[1] + data[2] + data[3];
+
+    for (unsigned char i = 0; i < 40; i++)
+    {
+        if (us < 50) return LOW;
+        us -= 50;
+        unsigned long long high = bitRead(data[i / 8], 7 - i % 8) ? 70 : 27;
+        if (us < high) return HIGH;
+        us -= high;
+    }
+    return us < 50 ? LOW : HIGH;
+}
+
+// ---------------------------------------------------------------- DS1302
+
+static unsigned char toBcd(int value) { return ((value / 10) << 4) | (value % 10); }
+
+// Clocks the command in on rising SCLK edges (LSB first); after a burst read command each
+// falling edge puts the next bit of seconds, minutes, hours, date, month, day, year, WP on IO.
+void Sim::rtcPinWritten(unsigned char pin, unsigned char previous)
+{
+    RTCClock& rtc = rtcClock;
+    unsigned char level = pinLevels[pin];
+    if (pin == rtc.ce)
+    {
+        rtc.bit = 0;
+        rtc.command = 0;
+        rtc.reading = false;
+        return;
+    }
+    if (pin != rtc.sclk || !pinLevels[rtc.ce] || level == previous) return;
+
+    if (!rtc.reading && level)
+    {
+        if (pinLevels[rtc.io]) rtc.command |= 1 << rtc.bit;
+        if (++rtc.bit < 8) return;
+        rtc.bit = 0;
+        if (rtc.command != 0xBF) return; // CLOCK_BURST_READ
+        time_t now = (time_t)(rtc.epoch + (long long)((micros() - rtc.setAt) / 1000000ULL));
+        struct tm t;
+        gmtime_r(&now, &t);
+        rtc.data[0] = toBcd(t.tm_sec);
+        rtc.data[1] = toBcd(t.tm_min);
+        rtc.data[2] = toBcd(t.tm_hour);
+        rtc.data[3] = toBcd(t.tm_mday);
+        rtc.data[4] = toBcd(t.tm_mon + 1);
+        rtc.data[5] = t.tm_wday ? t.tm_wday : 7;
+        rtc.data[6] = toBcd(t.tm_year % 100);
+        rtc.data[7] = 0;
+        rtc.reading = true;
+    }
+    else if (rtc.reading && !level && rtc.bit < 64)
+    {
+        pinLevels[rtc.io] = (rtc.data[rtc.bit / 8] >> (rtc.bit % 8)) & 1;
+        rtc.bit++;
+    }
+}
+
+// ---------------------------------------------------------------- EEPROM
+
+static unsigned long long eepromBusyUntil = 0; // us
+
+// erased chip unless a file from an earlier run is given
+bool Sim::loadEeprom(const char* path)
+{
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    if (!path) return true;
+    FILE* file = fopen(path, "rb");
+    if (!file) return true; // first run
+    size_t length = fread(eeprom, 1, sizeof(eeprom), file);
+    fclose(file);
+    return length == sizeof(eeprom);
+}
+
+bool Sim::saveEeprom(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    size_t length = fwrite(eeprom, 1, sizeof(eeprom), file);
+    fclose(file);
+    return length == sizeof(eeprom);
+}
+
+bool sim_eeprom_is_ready() { return micros() >= eepromBusyUntil; }
+
+uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+    size_t index = (size_t)addr;
+    return (index < SIM_EEPROM_SIZE) ? Sim::eeprom[index] : 0xFF;
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) ((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+}
+
+void eeprom_write_byte(uint8_t* addr, uint8_t value)
+{
+    unsigned long long now = micros();
+    if (now < eepromBusyUntil)
+    {
+        Sim::stats.eepromStallUs += eepromBusyUntil - now;
+        if (Sim::virtualClock) Sim::advanceTo(eepromBusyUntil);
+        else delayMicroseconds(eepromBusyUntil - now);
+        now = eepromBusyUntil;
+    }
+    size_t index = (size_t)addr;
+    if (index < SIM_EEPROM_SIZE && (long)index != Sim::eepromStuck) Sim::eeprom[index] = value;
+    Sim::stats.eepromWrites++;
+    eepromBusyUntil = now + SIM_EEPROM_WRITE_US;
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value)
+{
+    if (eeprom_read_byte(addr) != value) eeprom_write_byte(addr, value);
+}
+
+// ---------------------------------------------------------------- U8g2
+
+void U8G2::setContrast(unsigned char value)
+{
+    _contrast = value;
+    Sim::stats.contrastWrites++;
+    if (Sim::trace) printf("# %lu contrast %u\n", millis(), value);
+}
+
+void U8G2::firstPage()
+{
+    _page = 0;
+    Sim::stats.framesDrawn++;
+    Sim::stats.pagesDrawn++;
+}
+
+unsigned char U8G2::nextPage()
+{
+    if (Sim::virtualClock) Sim::advanceTo(micros() + U8G2_SIM_PAGE_US);
+    if (++_page >= U8G2_SIM_PAGES) return 0;
+    Sim::stats.pagesDrawn++;
+    return 1;
+}
+
+// ---------------------------------------------------------------- ESP8266 on Serial1
+
+// Raw AT commands written to Serial1 (not through the WiFiEsp stand-in) get the module's
+// answer, readable once the exchange would have taken its time. A missing module stays silent.
+// Link 0 carries the HTTP request: AT+CIPSTART, AT+CIPSEND and its data, +IPD, AT+CIPCLOSE.
+static char espLine[96]; // longest is AT+CWJAP_CUR with the SSID and password
+static size_t espLineLen = 0;
+static char espOut[128];
+static const char* espReply = nullptr;
+static unsigned long long espReplyAt = 0; // us
+static unsigned long long espTxDone = 0;  // us, when the last byte written has left Serial1
+
+static bool espLinked = false;
+static size_t espData = 0;     // bytes still to come after an AT+CIPSEND
+static size_t espDataLen = 0;
+static bool espInBody = false;
+static char espHeader[32];     // header line of the request, for its Content-Length
+static size_t espHeaderLen = 0;
+static long espBodyLeft = 0;
+
+static const char SIM_HTTP_RESPONSE[] = "HTTP/1.1 204 No Content\r\n\r\n";
+
+// the answer comes `ms` after the command has gone out
+static void espAnswer(const char* reply, unsigned long ms)
+{
+    snprintf(espOut, sizeof(espOut), "%s", reply);
+    espReply = espOut;
+    espReplyAt = espTxDone + ms * 1000ULL;
+}
+
+static void espCloseLink()
+{
+    if (espInBody && Sim::trace) printf("\n# http body end\n");
+    espLinked = false;
+    espInBody = false;
+}
+
+// request bytes as the server sees them, with --trace the body is echoed to stdout
+static void espReceive(unsigned char c)
+{
+    Sim::stats.httpBytes++;
+    if (espInBody)
+    {
+        if (Sim::trace) putchar(c);
+        espBodyLeft--;
+        return;
+    }
+    if (c == '\r') return;
+    if (c != '\n')
+    {
+        if (espHeaderLen < sizeof(espHeader) - 1) espHeader[espHeaderLen++] = c;
+        return;
+    }
+    espHeader[espHeaderLen] = '\0';
+    if (!strncmp(espHeader, "Content-Length: ", 16)) espBodyLeft = atol(espHeader + 16);
+    if (espHeaderLen == 0)
+    {
+        espInBody = true;
+        if (Sim::trace) printf("# %lu http body:\n", millis());
+    }
+    espHeaderLen = 0;
+}
+
+// SEND OK once the data is out, and the server's answer after the last byte of the body
+static void espSent()
+{
+    if (!Sim::wifiUp || !Sim::serverUp)
+    {
+        espCloseLink();
+        espAnswer("\r\nSEND FAIL\r\n", SIM_WIFI_SEND_US / 1000);
+        return;
+    }
+    int n = snprintf(espOut, sizeof(espOut), "\r\nRecv %zu bytes\r\n\r\nSEND OK\r\n", espDataLen);
+    if (espInBody && espBodyLeft <= 0)
+        snprintf(espOut + n, sizeof(espOut) - n, "\r\n+IPD,0,%zu,192.168.100.1,8086:%s0,CLOSED\r\n",
+                 strlen(SIM_HTTP_RESPONSE), SIM_HTTP_RESPONSE);
+    espReply = espOut;
+    espReplyAt = espTxDone + SIM_WIFI_SEND_US;
+}
+
+void Sim::espWrite(unsigned char c)
+{
+    // 115200 baud, HardwareSerial buffers SIM_ESP_TX_BUFFER bytes and write() waits for room
+    unsigned long long now = micros();
+    if (espTxDone < now) espTxDone = now;
+    else if (espTxDone - now >= SIM_ESP_TX_BUFFER * SIM_WIFI_BYTE_US)
+        delayMicroseconds(espTxDone - now - (SIM_ESP_TX_BUFFER - 1) * SIM_WIFI_BYTE_US);
+    espTxDone += SIM_WIFI_BYTE_US;
+
+    if (espData)
+    {
+        espReceive(c);
+        if (--espData == 0 && wifiPresent) espSent();
+        return;
+    }
+    if (c == '\r') return;
+    if (c != '\n')
+    {
+        if (espLineLen < sizeof(espLine) - 1) espLine[espLineLen++] = c;
+        return;
+    }
+    espLine[espLineLen] = '\0';
+    espLineLen = 0;
+    if (!wifiPresent) return;
+    if (!strcmp(espLine, "AT")) espAnswer("AT\r\n\r\nOK\r\n", SIM_ESP_AT_MS); // echo is on until init()
+    else if (!strncmp(espLine, "AT+CWJAP_CUR=", 13))
+    {
+        if (wifiUp) espAnswer("WIFI CONNECTED\r\nWIFI GOT IP\r\n\r\nOK\r\n", SIM_WIFI_JOIN_MS);
+        else espAnswer("+CWJAP:3\r\n\r\nFAIL\r\n", SIM_WIFI_JOIN_FAIL_MS);
+    }
+    else if (!strcmp(espLine, "AT+CIPSTATUS"))
+        espAnswer(wifiUp ? "STATUS:2\r\n\r\nOK\r\n" : "STATUS:5\r\n\r\nOK\r\n", SIM_ESP_AT_MS);
+    else if (!strncmp(espLine, "AT+CIPSTART=0,", 14))
+    {
+        if (!wifiUp) espAnswer("no ip\r\n\r\nERROR\r\n", SIM_ESP_AT_MS);
+        else if (!serverUp) espAnswer("ERROR\r\n0,CLOSED\r\n", SIM_WIFI_CONNECT_FAIL_MS);
+        else
+        {
+            espLinked = true;
+            espInBody = false;
+            espHeaderLen = 0;
+            espBodyLeft = 0;
+            stats.httpRequests++;
+            espAnswer("0,CONNECT\r\n\r\nOK\r\n", SIM_WIFI_CONNECT_MS);
+        }
+    }
+    else if (!strncmp(espLine, "AT+CIPSEND=0,", 13))
+    {
+        if (espLinked)
+        {
+            espDataLen = espData = strtoul(espLine + 13, nullptr, 10);
+            espAnswer("\r\nOK\r\n> ", SIM_ESP_AT_MS);
+        }
+        else espAnswer("link is not valid\r\n\r\nERROR\r\n", SIM_ESP_AT_MS);
+    }
+    else if (!strcmp(espLine, "AT+CIPCLOSE=0"))
+    {
+        if (espLinked)
+        {
+            espCloseLink();
+            espAnswer("0,CLOSED\r\n\r\nOK\r\n", SIM_WIFI_CLOSE_MS);
+        }
+        else espAnswer("UNLINK\r\n\r\nERROR\r\n", SIM_ESP_AT_MS);
+    }
+    else espAnswer("\r\nERROR\r\n", SIM_ESP_AT_MS);
+}
+
+int Sim::espAvailable() { return (espReply && micros() >= espReplyAt) ? (int)strlen(espReply) : 0; }
+
+int Sim::espRead()
+{
+    if (!espAvailable()) return -1;
+    char c = *espReply++;
+    if (!*espReply) espReply = nullptr;
+    return c;
+}
+
+int Sim::espPeek() { return espAvailable() ? *espReply : -1; }
+
+// ---------------------------------------------------------------- WiFiEsp
+
+WiFiEspClass WiFi;
+
+unsigned char WiFiEspClass::status()
+{
+    if (!Sim::wifiPresent) return WL_NO_SHIELD;
+    return Sim::wifiUp ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+void WiFiEspClass::init(Stream* espSerial)
+{
+    (void)espSerial;
+    delay(Sim::wifiPresent ? SIM_WIFI_INIT_MS : SIM_WIFI_PROBE_MS);
+    espCloseLink(); // AT+RST drops the link
+}
+
+int WiFiEspClass::begin(const char* ssid, const char* pass)
+{
+    (void)ssid;
+    (void)pass;
+    if (!Sim::wifiPresent) return WL_NO_SHIELD;
+    delay(Sim::wifiUp ? SIM_WIFI_JOIN_MS : SIM_WIFI_JOIN_FAIL_MS);
+    return Sim::wifiUp ? WL_CONNECTED : WL_CONNECT_FAILED;
+}
+
+IPAddress WiFiEspClass::localIP() { return Sim::wifiUp ? IPAddress(192, 168, 100, 50) : IPAddress(); }
@@ -0,0 +1,301 @@
+// Entry point of the native build: runs the unmodified setup()/loop() against a scripted board.
+//
+// usage: program [--script file] [--duration time] [--fast] [--trace] [--eeprom file]
+//
+// --fast switches to a virtual clock: whenever the scheduler has nothing due, time jumps straight
+// to the next task deadline or script event, so a simulated day takes seconds of wall time.
+//
+// --eeprom keeps the EEPROM contents in a file: read before setup() (erased if it does not exist yet)
+// and written back at the end, so a second run boots with the settings the first one saved.
+//
+// Script lines are "<time> <command> [args]", applied once the firmware clock reaches <time>.
+// Times are in ms, or with an s/m/h suffix. '#' starts a comment. Commands:
+//   analog <pin> <0..1023>        value returned by analogRead (pins as 54 or A0)
+//   digital <pin> <0|1>           input level, fires attached interrupts (encoder: 2, 3)
+//   dht <pin> <temp> <hum>        DHT11 reading, "dht <pin> fail" makes the sensor absent
+//   rtc <sclk> <io> <ce> <YYYY-MM-DD> <HH:MM:SS>   DS1302 on those pins, running from that time
+//   i2c <addr> <byte>...          bytes returned by requestFrom, "i2c <addr> off" stops answering
+//   wifi up|down|missing          ESP8266 link state
+//   server up|down                InfluxDB reachability
+//   serial <text>                 line sent to the firmware on Serial
+//   eeprom stuck <addr>|ok        writes to that EEPROM byte no longer stick (worn cell), ok heals it
+//   end                           stop the run
+
+#include <Arduino.h>
+#include <Sim.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#define SIM_MAX_EVENTS 1024
+#define SIM_LINE_LENGTH 160
+#define SIM_PASS_COST_US 10
+
+struct SimEvent
+{
+    unsigned long time; //ms
+    char line[SIM_LINE_LENGTH];
+};
+
+static SimEvent simEvents[SIM_MAX_EVENTS];
+static unsigned short simEventCount = 0;
+static unsigned short simEventNext = 0;
+static bool simEnd = false;
+static unsigned long simDuration = 10000; //ms
+
+static bool parseTime(const char* str, unsigned long* ms)
+{
+    char* end = nullptr;
+    double value = strtod(str, &end);
+    if (end == str) return false;
+    switch (*end)
+    {
+        case 'h': value *= 3600000.0; break;
+        case 'm': value *= 60000.0; break;
+        case 's': value *= 1000.0; break;
+        case '\0': break;
+        default: return false;
+    }
+    *ms = (unsigned long)value;
+    return true;
+}
+
+static int parsePin(const char* str)
+{
+    if (str[0] == 'A' || str[0] == 'a') return A0 + atoi(str + 1);
+    return atoi(str);
+}
+
+static bool loadScript(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "sim: cannot open %s\n", path);
+        return false;
+    }
+    char line[SIM_LINE_LENGTH];
+    unsigned int lineNo = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        lineNo++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char* time = strtok(line, " \t\r\n");
+        if (!time) continue;
+        char* rest = strtok(nullptr, "\r\n");
+        SimEvent& event = simEvents[simEventCount];
+        if (!parseTime(time, &event.time) || !rest || simEventCount >= SIM_MAX_EVENTS)
+        {
+            fprintf(stderr, "sim: %s:%u: bad line\n", path, lineNo);
+            fclose(file);
+            return false;
+        }
+        while (*rest == ' ' || *rest == '\t') rest++;
+        strncpy(event.line, rest, sizeof(event.line) - 1);
+        event.line[sizeof(event.line) - 1] = '\0';
+        simEventCount++;
+    }
+    fclose(file);
+    // keep script order for equal times
+    for (unsigned short i = 1; i < simEventCount; i++)
+        for (unsigned short j = i; j > 0 && simEvents[j].time < simEvents[j - 1].time; j--)
+        {
+            SimEvent tmp = simEvents[j];
+            simEvents[j] = simEvents[j - 1];
+            simEvents[j - 1] = tmp;
+        }
+    return true;
+}
+
+static void applyEvent(SimEvent& event)
+{
+    char buf[SIM_LINE_LENGTH];
+    strcpy(buf, event.line);
+    char* cmd = strtok(buf, " \t");
+    if (!cmd) return;
+    if (Sim::trace) printf("# %lu sim %s\n", millis(), event.line);
+
+    if (!strcmp(cmd, "analog"))
+    {
+        char* pin = strtok(nullptr, " \t");
+        char* value = strtok(nullptr, " \t");
+        if (!pin || !value) return;
+        int p = parsePin(pin);
+        if (p >= 0 && p < NUM_DIGITAL_PINS) Sim::analogValues[p] = atoi(value);
+    }
+    else if (!strcmp(cmd, "digital"))
+    {
+        char* pin = strtok(nullptr, " \t");
+        char* level = strtok(nullptr, " \t");
+        if (pin && level) Sim::setDigitalInput(parsePin(pin), atoi(level));
+    }
+    else if (!strcmp(cmd, "dht"))
+    {
+        char* pin = strtok(nullptr, " \t");
+        char* arg = strtok(nullptr, " \t");
+        Sim::DHTInput* dht = pin ? Sim::dhtInput(parsePin(pin), true) : nullptr;
+        if (!dht || !arg) return;
+        dht->present = strcmp(arg, "fail") != 0;
+        if (dht->present)
+        {
+            dht->temperature = atof(arg);
+            char* hum = strtok(nullptr, " \t");
+            dht->humidity = hum ? atof(hum) : 0;
+        }
+    }
+    else if (!strcmp(cmd, "rtc"))
+    {
+        char* sclk = strtok(nullptr, " \t");
+        char* io = strtok(nullptr, " \t");
+        char* ce = strtok(nullptr, " \t");
+        char* date = strtok(nullptr, " \t");
+        char* clock = strtok(nullptr, " \t");
+        struct tm t = {};
+        if (!sclk || !io || !ce || !date || !clock
+            || sscanf(date, "%d-%d-%d", &t.tm_year, &t.tm_mon, &t.tm_mday) != 3
+            || sscanf(clock, "%d:%d:%d", &t.tm_hour, &t.tm_min, &t.tm_sec) != 3)
+        {
+            fprintf(stderr, "sim: bad rtc line\n");
+            return;
+        }
+        t.tm_year -= 1900;
+        t.tm_mon -= 1;
+        Sim::rtcClock.sclk = parsePin(sclk);
+        Sim::rtcClock.io = parsePin(io);
+        Sim::rtcClock.ce = parsePin(ce);
+        Sim::rtcClock.epoch = timegm(&t);
+        Sim::rtcClock.setAt = micros();
+        Sim::rtcClock.present = true;
+    }
+    else if (!strcmp(cmd, "i2c"))
+    {
+        char* addr = strtok(nullptr, " \t");
+        Sim::I2CDevice* dev = addr ? Sim::i2cDevice(strtol(addr, nullptr, 0), true) : nullptr;
+        if (!dev) return;
+        char* arg = strtok(nullptr, " \t");
+        dev->present = !(arg && !strcmp(arg, "off"));
+        if (!dev->present) return;
+        for (unsigned char i = 0; arg && i < SIM_I2C_BYTES; i++, arg = strtok(nullptr, " \t"))
+            dev->data[i] = strtol(arg, nullptr, 0);
+    }
+    else if (!strcmp(cmd, "wifi"))
+    {
+        char* arg = strtok(nullptr, " \t");
+        if (!arg) return;
+        Sim::wifiPresent = strcmp(arg, "missing") != 0;
+        Sim::wifiUp = !strcmp(arg, "up");
+    }
+    else if (!strcmp(cmd, "server"))
+    {
+        char* arg = strtok(nullptr, " \t");
+        if (arg) Sim::serverUp = !strcmp(arg, "up");
+    }
+    else if (!strcmp(cmd, "eeprom"))
+    {
+        char* arg = strtok(nullptr, " \t");
+        if (!arg) return;
+        if (!strcmp(arg, "stuck"))
+        {
+            char* addr = strtok(nullptr, " \t");
+            if (addr) Sim::eepromStuck = strtol(addr, nullptr, 0);
+        }
+        else if (!strcmp(arg, "ok")) Sim::eepromStuck = -1;
+    }
+    else if (!strcmp(cmd, "serial"))
+    {
+        char* text = strtok(nullptr, "");
+        Sim::serialInject(text ? text : "");
+    }
+    else if (!strcmp(cmd, "end")) simEnd = true;
+    else fprintf(stderr, "sim: unknown command '%s'\n", cmd);
+}
+
+// Overrides the firmware's weak no-op: with the virtual clock an idle pass skips ahead.
+void schedulerIdle(unsigned long deadline)
+{
+    if (!Sim::virtualClock) return;
+    unsigned long now = millis();
+    unsigned long target = deadline;
+    if ((long)(target - now) <= 0) target = now + 1;
+    if (simEventNext < simEventCount && simEvents[simEventNext].time < target) target = simEvents[simEventNext].time;
+    if (simDuration < target) target = simDuration;
+    Sim::advanceTo(1000ULL * target);
+}
+
+static void applyDueEvents()
+{
+    while (simEventNext < simEventCount && simEvents[simEventNext].time <= millis())
+        applyEvent(simEvents[simEventNext++]);
+}
+
+int main(int argc, char** argv)
+{
+    const char* eepromPath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--script") && i + 1 < argc)
+        {
+            if (!loadScript(argv[++i])) return 1;
+        }
+        else if (!strcmp(argv[i], "--duration") && i + 1 < argc)
+        {
+            if (!parseTime(argv[++i], &simDuration))
+            {
+                fprintf(stderr, "sim: bad duration %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--fast")) Sim::virtualClock = true;
+        else if (!strcmp(argv[i], "--trace")) Sim::trace = true;
+        else if (!strcmp(argv[i], "--eeprom") && i + 1 < argc) eepromPath = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--script file] [--duration time] [--fast] [--trace] [--eeprom file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!Sim::loadEeprom(eepromPath))
+    {
+        fprintf(stderr, "sim: bad eeprom file %s\n", eepromPath);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    applyDueEvents();
+    setup();
+    long heapAfterSetup = Sim::stats.heapBytes;
+    while (!simEnd && millis() < simDuration)
+    {
+        applyDueEvents();
+        unsigned long long before = micros();
+        loop();
+        Sim::stats.loops++;
+        // a pass that ran tasks still costs the MCU some time, this also guarantees progress
+        if (Sim::virtualClock && micros() == before) Sim::advanceTo(before + SIM_PASS_COST_US);
+    }
+
+    if (eepromPath && !Sim::saveEeprom(eepromPath)) fprintf(stderr, "sim: cannot write %s\n", eepromPath);
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    fflush(stdout);
+    fprintf(stderr, "\n--- sim summary ---\n");
+    fprintf(stderr, "firmware time   %lu ms\n", millis());
+    fprintf(stderr, "wall time       %.3f s (%.1f simulated h/s)\n", wall, wall > 0 ? millis() / 3600000.0 / wall : 0.0);
+    fprintf(stderr, "loop passes     %lu (%.3f us/pass)\n", Sim::stats.loops,
+            Sim::stats.loops ? wall * 1e6 / Sim::stats.loops : 0.0);
+    fprintf(stderr, "pin writes      %lu\n", Sim::stats.pinWrites);
+    fprintf(stderr, "analog reads    %lu\n", Sim::stats.analogReads);
+    fprintf(stderr, "i2c requests    %lu\n", Sim::stats.i2cRequests);
+    fprintf(stderr, "display frames  %lu (%lu pages, %lu contrast writes)\n", Sim::stats.framesDrawn, Sim::stats.pagesDrawn,
+            Sim::stats.contrastWrites);
+    fprintf(stderr, "eeprom          %lu byte writes, %lu us stalled\n", Sim::stats.eepromWrites, Sim::stats.eepromStallUs);
+    fprintf(stderr, "http requests   %lu (%lu bytes)\n", Sim::stats.httpRequests, Sim::stats.httpBytes);
+    fprintf(stderr, "heap            %ld B after setup, %ld B now, %ld B peak, %lu allocations\n",
+            heapAfterSetup, Sim::stats.heapBytes, Sim::stats.heapPeak, Sim::stats.allocations);
+    return 0;
+}
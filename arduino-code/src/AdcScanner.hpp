@@ -0,0 +1,168 @@
+#pragma once
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#endif
+
+#define ADC_SCAN_CHANNELS 4    // A0..A3: soil 1-3, light
+#define ADC_SCAN_OVERSAMPLE 16 // 16 samples -> 2 extra bits
+#define ADC_SCAN_RING 4        // blocks averaged per channel, must be a power of two
+#define ADC_SCAN_MAX 4092      // 1023 << 2, full scale of a decimated value
+
+// Free running scan of A0..A3 from the ADC complete interrupt. Each channel gets a block of
+// ADC_SCAN_OVERSAMPLE conversions (the first one after switching the mux is dropped, the soil
+// probes are high impedance), decimated to 12 bit and pushed into a small ring per channel.
+// Readers get the ring average in O(1), no conversion ever runs in the loop.
+class AdcScanner
+{
+private:
+    volatile unsigned short _ring[ADC_SCAN_CHANNELS][ADC_SCAN_RING];
+    volatile unsigned short _sum[ADC_SCAN_CHANNELS];
+    volatile unsigned char _pos[ADC_SCAN_CHANNELS];
+    volatile unsigned char _ready = 0; // bit per channel, set after its first block
+
+    unsigned char _channel = 0;
+    unsigned char _samples = 0;
+    unsigned short _acc = 0;
+    bool _discard = true;
+
+    void _push(unsigned char channel, unsigned short value);
+#ifdef __AVR__
+    void _isr();
+    void _select(unsigned char channel);
+#endif
+
+    static AdcScanner* _instance;
+
+public:
+    AdcScanner();
+    void Init();
+    void update();
+    unsigned short read(unsigned char pin);
+    bool ready(unsigned char pin);
+    void restart(unsigned char pin);
+
+    static void wrapperInterrupt();
+    static void wrapperUpdate(const void* context);
+};
+
+AdcScanner* AdcScanner::_instance = nullptr;
+
+AdcScanner::AdcScanner() {}
+
+// Runs in the ISR (or update() on the host), readers only see whole blocks.
+void AdcScanner::_push(unsigned char channel, unsigned short value)
+{
+    if (!(_ready & (1 << channel)))
+    {
+        // first block fills the whole ring so early readers do not see a ramp from zero
+        for (unsigned char i = 0; i < ADC_SCAN_RING; i++) _ring[channel][i] = value;
+        _sum[channel] = value * ADC_SCAN_RING;
+        _ready |= 1 << channel;
+        return;
+    }
+    unsigned char pos = _pos[channel];
+    _sum[channel] += value - _ring[channel][pos];
+    _ring[channel][pos] = value;
+    _pos[channel] = (pos + 1) & (ADC_SCAN_RING - 1);
+}
+
+#ifdef __AVR__
+void AdcScanner::Init()
+{
+    _instance = this;
+    DIDR0 |= (1 << ADC_SCAN_CHANNELS) - 1; // no digital input buffers on the scanned pins
+    _select(0);
+    ADCSRA = _BV(ADEN) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0); // 16 MHz / 128
+    ADCSRA |= _BV(ADSC);
+    Serial.println(F("ADC scanner initialized"));
+}
+
+inline void AdcScanner::_select(unsigned char channel)
+{
+    ADCSRB &= ~_BV(MUX5);
+    ADMUX = _BV(REFS0) | channel; // AVcc reference, same as analogRead() DEFAULT
+}
+
+void AdcScanner::_isr()
+{
+    unsigned short sample = ADC;
+    if (_discard) _discard = false;
+    else
+    {
+        _acc += sample;
+        if (++_samples >= ADC_SCAN_OVERSAMPLE)
+        {
+            _push(_channel, _acc >> 2);
+            _acc = 0;
+            _samples = 0;
+            _channel = (_channel + 1) % ADC_SCAN_CHANNELS;
+            _select(_channel);
+            _discard = true;
+        }
+    }
+    ADCSRA |= _BV(ADSC);
+}
+
+ISR(ADC_vect) { AdcScanner::wrapperInterrupt(); }
+
+// Everything happens in the interrupt, nothing to do here on the board.
+inline void AdcScanner::update() {}
+#else
+void AdcScanner::Init()
+{
+    _instance = this;
+    update();
+    Serial.println(F("ADC scanner initialized"));
+}
+
+// No ADC interrupt on the host: one block per channel per call. The scripted inputs have no
+// noise, so a single analogRead() stands for the whole oversampled block.
+void AdcScanner::update()
+{
+    for (unsigned char channel = 0; channel < ADC_SCAN_CHANNELS; channel++)
+        _push(channel, analogRead(A0 + channel) << 2);
+}
+#endif
+
+// Averaged 12 bit value (0..ADC_SCAN_MAX) of a scanned pin (A0..A3), 0 for other pins.
+unsigned short AdcScanner::read(unsigned char pin)
+{
+    unsigned char channel = pin - A0;
+    if (channel >= ADC_SCAN_CHANNELS) return 0;
+    noInterrupts();
+    unsigned short sum = _sum[channel];
+    interrupts();
+    return sum / ADC_SCAN_RING;
+}
+
+inline bool AdcScanner::ready(unsigned char pin)
+{
+    unsigned char channel = pin - A0;
+    return channel < ADC_SCAN_CHANNELS && (_ready & (1 << channel));
+}
+
+// Forgets the averaged history of a pin, ready() stays false until a whole new block is in.
+void AdcScanner::restart(unsigned char pin)
+{
+    unsigned char channel = pin - A0;
+    if (channel >= ADC_SCAN_CHANNELS) return;
+    noInterrupts();
+    _ready &= ~(1 << channel);
+    interrupts();
+}
+
+void AdcScanner::wrapperInterrupt()
+{
+#ifdef __AVR__
+    if (_instance) _instance->_isr();
+#endif
+}
+
+void AdcScanner::wrapperUpdate(const void* context)
+{
+    AdcScanner* obj = (AdcScanner*)context;
+    obj->update();
+}
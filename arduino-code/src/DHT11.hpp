@@ -0,0 +1,141 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Fixed.hpp"
+
+#define DHT11_START_LOW 20     //ms, host start pulse (datasheet: at least 18 ms)
+#define DHT11_EDGE_TIMEOUT 120 //us, longest valid level in a frame is 80 us
+#define DHT11_BIT_THRESHOLD 48 //us, high part of a bit: ~27 us = 0, ~70 us = 1
+
+enum DHT11State
+{
+    DHT11_IDLE,
+    DHT11_START,
+    DHT11_DONE,
+    DHT11_FAILED
+};
+
+// Non-blocking DHT11 driver. start() pulls the line low and returns, the following update()
+// calls finish the start pulse and capture one 40 bit frame, so temperature and humidity
+// always come from the same transfer. Interrupts stay enabled the whole time; every bit is
+// ~50 us low + 27/70 us high so a few us spent in an ISR does not move it across the threshold.
+class DHT11
+{
+private:
+    unsigned char _pin;
+#ifdef __AVR__
+    volatile unsigned char* _in = nullptr; // PINx of _pin, resolved once in begin()
+    unsigned char _mask = 0;
+#endif
+    DHT11State _state = DHT11_IDLE;
+    unsigned long _start = 0; //ms
+    unsigned char _data[5];
+    unsigned long _errors = 0;
+
+    unsigned char _level();
+    unsigned char _waitWhile(unsigned char level);
+    bool _readFrame();
+
+public:
+    DHT11(unsigned char pin);
+    void begin();
+    bool start();
+    DHT11State update();
+
+    Centi temperature();
+    Centi humidity();
+    unsigned long errors();
+};
+
+DHT11::DHT11(unsigned char pin) : _pin(pin) {}
+
+inline void DHT11::begin()
+{
+#ifdef __AVR__
+    _in = portInputRegister(digitalPinToPort(_pin));
+    _mask = digitalPinToBitMask(_pin);
+#endif
+    pinMode(_pin, INPUT_PULLUP);
+    _state = DHT11_IDLE;
+}
+
+// Begins the start pulse, false if a transfer is already running.
+inline bool DHT11::start()
+{
+    if (_state == DHT11_START) return false;
+    pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, LOW);
+    _start = millis();
+    _state = DHT11_START;
+    return true;
+}
+
+// Returns DHT11_DONE/DHT11_FAILED once per finished transfer, DHT11_IDLE otherwise.
+DHT11State DHT11::update()
+{
+    if (_state != DHT11_START || millis() - _start < DHT11_START_LOW) return DHT11_IDLE;
+
+    // sensor answers 20-40 us after the line is released, the frame must be followed from here on
+    pinMode(_pin, INPUT_PULLUP);
+    _state = _readFrame() ? DHT11_DONE : DHT11_FAILED;
+    if (_state == DHT11_FAILED) _errors++;
+    return _state;
+}
+
+// The pin number is only known at run time (two sensors share the class), so instead of FastPin
+// the frame poll reads the port register found in begin(): one load and a mask per sample.
+inline unsigned char DHT11::_level()
+{
+#ifdef __AVR__
+    return (*_in & _mask) ? HIGH : LOW;
+#else
+    return digitalRead(_pin);
+#endif
+}
+
+// Waits until the line leaves `level`, returns how long it stayed there (us) or 0 on timeout.
+unsigned char DHT11::_waitWhile(unsigned char level)
+{
+    unsigned long begin = micros();
+    unsigned long elapsed = 0;
+    while (_level() == level)
+    {
+        elapsed = micros() - begin;
+        if (elapsed > DHT11_EDGE_TIMEOUT) return 0;
+    }
+    return elapsed ? elapsed : 1;
+}
+
+bool DHT11::_readFrame()
+{
+    // response: released high, 80 us low, 80 us high
+    if (!_waitWhile(HIGH) || !_waitWhile(LOW) || !_waitWhile(HIGH)) return false;
+
+    memset(_data, 0, sizeof(_data));
+    for (unsigned char i = 0; i < 40; i++)
+    {
+        if (!_waitWhile(LOW)) return false;
+        unsigned char high = _waitWhile(HIGH);
+        if (!high) return false;
+        _data[i / 8] <<= 1;
+        if (high > DHT11_BIT_THRESHOLD) _data[i / 8] |= 1;
+    }
+    return (unsigned char)(_data[0] + _data[1] + _data[2] + _data[3]) == _data[4];
+}
+
+// integral byte + tenths byte, bit 7 of the tenths is the sign
+inline Centi DHT11::temperature()
+{
+    if (_state != DHT11_DONE) return CENTI_NAN;
+    Centi value = _data[2] * CENTI_ONE + (_data[3] & 0x7F) * 10;
+    return (_data[3] & 0x80) ? -value : value;
+}
+
+inline Centi DHT11::humidity()
+{
+    if (_state != DHT11_DONE) return CENTI_NAN;
+    return _data[0] * CENTI_ONE + _data[1] * 10;
+}
+
+inline unsigned long DHT11::errors() { return _errors; }
@@ -1,28 +1,60 @@
 #pragma once
 
-#include<ArduinoSTL.h>
-#include<DHT.h>
+#include "Observers.hpp"
+
+#include "DHT11.hpp"
 
 #include "DataTypes.hpp"
 
-using DHTCallback = void (*)(const void*, const float*, const float*);
+#define DHT_OBSERVERS 3 // processor, display, influx
+#define DHT_STALE_READS 3 // failed reads in a row before the last values are dropped
+
+using DHTCallback = void (*)(const void*, const Centi*, const Centi*);
+
+struct DHTData
+{
+    Centi temperature;
+    Centi humidity;
+};
 
 class DHTSensor
 {
 private:
     const ConfigUShort delay_cf = {wrapperReadDelay, 100, 60000, 50, "ms"};
+    const ConfigFloat _temp_band_cf = {wrapperTempBand, 0, CENTI(5), CENTI(0.1), "C"};
+    const ConfigFloat _hum_band_cf = {wrapperHumBand, 0, CENTI(20), CENTI(1), "%"};
+    const ConfigUShort _notify_interval_cf = {wrapperNotifyInterval, 0, 3600, 5, "s"};
 
     unsigned long _last_read = 0;
     unsigned short _read_delay = 10000; //ms
-    float _temperature = 0.0; 
-    float _humidity = 0.0;
-    
-    DHT _dht;
-    //DHTCallback _callback = nullptr;
-    std::vector<std::pair<const void*, DHTCallback>> _callbacks;
+    Centi _temperature = CENTI_NAN; // last notified values
+    Centi _humidity = CENTI_NAN;
+
+    // changes up to the band are not reported, bigger ones at most once per interval
+    Centi _temp_band = CENTI(0.2); //C
+    Centi _hum_band = CENTI(1); //%
+    unsigned short _notify_interval = 20; //s
+    unsigned long _last_notify = 0;
+    Centi _pending_temperature = CENTI_NAN;
+    Centi _pending_humidity = CENTI_NAN;
+    bool _pending = false;
+
+    unsigned char _stale = 0; // failed reads since the last good one
+    unsigned long _stale_total = 0; // times the values were dropped
+
+    DHT11 _dht;
+    Observers<DHTCallback, DHT_OBSERVERS> _callbacks;
+
+    static bool _outside(Centi value, Centi reference, Centi band);
+    void _readOk(Centi temperature, Centi humidity);
+    void _readFailed();
+    void _notify(Centi temperature, Centi humidity);
     
 public:
     const DataConfig delayConfig = {TYPE_USHORT, {.confUShort = &delay_cf}};
+    const DataConfig tempBandConfig = {TYPE_FLOAT, {.confFloat = &_temp_band_cf}};
+    const DataConfig humBandConfig = {TYPE_FLOAT, {.confFloat = &_hum_band_cf}};
+    const DataConfig notifyIntervalConfig = {TYPE_USHORT, {.confUShort = &_notify_interval_cf}};
 
     DHTSensor(unsigned char pin);
     void addCallback(const void* context, DHTCallback valueChagedCallback);
@@ -30,57 +62,99 @@ public:
     void readSensor();
 
     unsigned short readDelay(const unsigned short* delay);
-    std::pair<float, float> getLastData();
+    Centi tempBand(const Centi* band);
+    Centi humBand(const Centi* band);
+    unsigned short notifyInterval(const unsigned short* interval);
+    DHTData getLastData();
+    void printStatus(Print* out);
 
+    static void wrapperReadSensor(const void* context);
     static unsigned short wrapperReadDelay(const void* context, const unsigned short* delay);
-    //static std::pair<float, float> wrapperGetLastData()
+    static Centi wrapperTempBand(const void* context, const Centi* band);
+    static Centi wrapperHumBand(const void* context, const Centi* band);
+    static unsigned short wrapperNotifyInterval(const void* context, const unsigned short* interval);
+    static void wrapperStatusCommand(const void* context, Print* out, const char* args);
 };
 
-DHTSensor::DHTSensor(unsigned char pin) : _dht(pin, DHT11) {}
+DHTSensor::DHTSensor(unsigned char pin) : _dht(pin) {}
 
 inline void DHTSensor::addCallback(const void* context, DHTCallback valueChagedCallback)
 {
-    _callbacks.push_back(std::make_pair(context, valueChagedCallback));
+    _callbacks.add(context, valueChagedCallback);
 }
 
 inline void DHTSensor::Init() 
 { 
     _dht.begin(); 
-    Serial.print("DHT sensor initialized");
+    Serial.print(F("DHT sensor initialized"));
 }
 
+// Called often (every few ms): starts a transfer every _read_delay and picks up its result
+// on a later call, so the 20 ms start pulse never blocks the loop.
 inline void DHTSensor::readSensor()
 {
     if(millis() - _last_read >= _read_delay)
     {
-        float value = _dht.readTemperature();
-        bool check = false;
-        if(_temperature != value) 
-        {
-            check = true;
-            _temperature = value;
-        }
-        value = _dht.readHumidity();
-        if(_humidity != value)
-        {
-            check = true;
-            _humidity = value;
-        }
-
-        if(check)
-        {
-            for (const auto& callback : _callbacks)
-                {
-                    callback.second(callback.first, &_temperature, &_humidity);
-                }
-            Serial.print("DHT sensor data changed. Temp: ");
-            Serial.print(_temperature);
-            Serial.print(" Humidity: ");
-            Serial.println(_humidity);
-        }
-                
+        _dht.start();
         _last_read = millis();
     }
+
+    DHT11State state = _dht.update();
+    if(state == DHT11_DONE) _readOk(_dht.temperature(), _dht.humidity());
+    else if(state == DHT11_FAILED) _readFailed();
+
+    // a change held back by the interval goes out as soon as the interval is over,
+    // the first reading (or the first after the values were dropped) right away
+    if(_pending && (!centiValid(_temperature) || millis() - _last_notify >= (unsigned long)_notify_interval * 1000))
+        _notify(_pending_temperature, _pending_humidity);
+}
+
+inline bool DHTSensor::_outside(Centi value, Centi reference, Centi band)
+{
+    if(!centiValid(reference)) return true;
+    return abs((long)value - reference) > band;
+}
+
+void DHTSensor::_readOk(Centi temperature, Centi humidity)
+{
+    _stale = 0;
+    if(_outside(temperature, _temperature, _temp_band) || _outside(humidity, _humidity, _hum_band))
+    {
+        _pending_temperature = temperature;
+        _pending_humidity = humidity;
+        _pending = true;
+    }
+    else _pending = false; // back inside the band before the interval ran out
+}
+
+// A failed frame never reaches the observers as data. Only after DHT_STALE_READS of them in a row
+// the values become NaN (once), so nobody keeps acting on a reading that is getting old.
+void DHTSensor::_readFailed()
+{
+    Serial.print(F("DHT sensor read failed, errors: "));
+    Serial.println(_dht.errors());
+    if(_stale < 255) _stale++;
+    if(_stale != DHT_STALE_READS) return;
+    _pending = false;
+    if(centiValid(_temperature))
+    {
+        _stale_total++;
+        _notify(CENTI_NAN, CENTI_NAN);
+    }
+}
+
+void DHTSensor::_notify(Centi temperature, Centi humidity)
+{
+    _pending = false;
+    _last_notify = millis();
+    _temperature = temperature;
+    _humidity = humidity;
+    _callbacks.notify(&_temperature, &_humidity);
+    Serial.print(F("DHT sensor data changed. Temp: "));
+    printCenti(&Serial, _temperature, 2);
+    Serial.print(F(" Humidity: "));
+    printCenti(&Serial, _humidity, 2);
+    Serial.println();
 }
 
 inline unsigned short DHTSensor::readDelay(const unsigned short *delay)
@@ -93,6 +167,44 @@ inline unsigned short DHTSensor::readDelay(const unsigned short *delay)
     return _read_delay;
 }
 
+inline Centi DHTSensor::tempBand(const Centi* band)
+{
+    if(band) _temp_band = *band;
+    return _temp_band;
+}
+
+inline Centi DHTSensor::humBand(const Centi* band)
+{
+    if(band) _hum_band = *band;
+    return _hum_band;
+}
+
+inline unsigned short DHTSensor::notifyInterval(const unsigned short* interval)
+{
+    if(interval) _notify_interval = *interval;
+    return _notify_interval;
+}
+
+void DHTSensor::printStatus(Print* out)
+{
+    out->print(F("temp="));
+    printCenti(out, _temperature, 1);
+    out->print(F(" hum="));
+    printCenti(out, _humidity, 1);
+    out->print(F(" errors="));
+    out->print(_dht.errors());
+    out->print(F(" stale="));
+    out->print(_stale);
+    out->print(F(" dropped="));
+    out->println(_stale_total);
+}
+
+void DHTSensor::wrapperReadSensor(const void* context)
+{
+    DHTSensor* obj = (DHTSensor*)context;
+    obj->readSensor();
+}
+
 unsigned short DHTSensor::wrapperReadDelay(const void* context, const unsigned short *delay)
 {
     DHTSensor* obj = (DHTSensor*)context;
@@ -100,4 +212,30 @@ unsigned short DHTSensor::wrapperReadDelay(const void* context, const unsigned s
     return obj->readDelay(delay);
 }
 
-inline std::pair<float, float> DHTSensor::getLastData() { return std::make_pair(_temperature, _humidity); }
+Centi DHTSensor::wrapperTempBand(const void* context, const Centi* band)
+{
+    DHTSensor* obj = (DHTSensor*)context;
+    return obj->tempBand(band);
+}
+
+Centi DHTSensor::wrapperHumBand(const void* context, const Centi* band)
+{
+    DHTSensor* obj = (DHTSensor*)context;
+    return obj->humBand(band);
+}
+
+unsigned short DHTSensor::wrapperNotifyInterval(const void* context, const unsigned short* interval)
+{
+    DHTSensor* obj = (DHTSensor*)context;
+    return obj->notifyInterval(interval);
+}
+
+// "dht_in"/"dht_out": last notified values, read errors, failed reads in a row, times the values were dropped
+void DHTSensor::wrapperStatusCommand(const void* context, Print* out, const char* args)
+{
+    (void)args;
+    DHTSensor* obj = (DHTSensor*)context;
+    obj->printStatus(out);
+}
+
+inline DHTData DHTSensor::getLastData() { return {_temperature, _humidity}; }
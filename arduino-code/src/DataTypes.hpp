@@ -1,6 +1,15 @@
 #pragma once
 
-using CbFloat  = float (*)(const void* context, const float *val);
+#include "Fixed.hpp"
+
+#define CONFIG_OPTION_LENGTH 9 // "WILGOTNY" + '\0'
+
+// texts of bool and enum settings are kept in flash (PROGMEM)
+const char CONFIG_ON[] PROGMEM = "ON";
+const char CONFIG_OFF[] PROGMEM = "OFF";
+
+// TYPE_FLOAT settings are fixed point (Centi), the name only says they have decimals
+using CbFloat  = Centi (*)(const void* context, const Centi *val);
 using CbUChar  = unsigned char (*)(const void* context, const unsigned char *val);
 using CbUShort = unsigned short (*)(const void* context, const unsigned short *val);
 using CbBool   = bool (*)(const void* context, const bool *val);
@@ -36,23 +45,23 @@ struct ConfigUShort
 struct ConfigFloat
 {
     const CbFloat callback;
-    const float minVal;
-    const float maxVal;
-    const float step;
+    const Centi minVal;
+    const Centi maxVal;
+    const Centi step;
     const char *unit;
 };
 
 struct ConfigBool
 {
     const CbBool callback;
-    const char *txtOn;
-    const char *txtOff;
+    const char *txtOn;  // PROGMEM
+    const char *txtOff; // PROGMEM
 };
 
 struct ConfigEnum
 {
     const CbEnum callback;
-    const char **options;
+    const char (*options)[CONFIG_OPTION_LENGTH]; // PROGMEM
     const char maxVal;
 };
 
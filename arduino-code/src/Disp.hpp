@@ -14,7 +14,15 @@
 #include "WaterLevelSensor.hpp"
 #include "Light.hpp"
 #include "Relays.hpp"
-#include "Processor.hpp"
+#include "Params.hpp"
+#include "TaskStats.hpp"
+#include "TextBuffer.hpp"
+
+#define DISP_SCREENS 5          // rotating screens 1..5
+#define DISP_MENU_SCREEN 6
+#define DISP_EDITOR_SCREEN 7
+#define DISP_DIRTY(screen) (1 << (screen))
+#define DISP_PAGE_BUDGET_US 1000 // another page is drawn in the same tick only while under this
 
 class Disp
 {
@@ -32,25 +40,33 @@ private:
     WaterLevelSensor* _water = nullptr;
     Light* _light = nullptr;
     Relays* _relays = nullptr;
-    Processor* _processor = nullptr;
-    const void* _father = nullptr;
+    ParamRegistry* _params = nullptr;
 
     unsigned char _brightness = 200;
     unsigned char _blanking_brightness = 75;
     unsigned char _blanking_time = 5;       // min
     unsigned long _blanking_start = 0;
-    unsigned char _screan_switch_time = 10; // s
+    unsigned char _screan_switch_time = 10; // s, 0 = no rotation
     unsigned long _last_switch_time = 0;
     unsigned char _screen_num = 1;
     unsigned char _back_to_switching_time = 90; // s
     bool _turned = false;
-    bool _manual_mode = false;
-    String _time = "00:00";
-    String _date = "01.01.2025";
-    float _temp_in = 0;
-    float _temp_out = 0;
-    float _hum_in = 0;
-    float _hum_out = 0;
+    bool _blanked = false;
+    unsigned char _dirty = DISP_DIRTY(1); // DISP_DIRTY(n): inputs of screen n changed since it was drawn
+    unsigned char _minute = 255;
+    unsigned long _clock_read = 0;
+    unsigned long _clock_wait = 0;        // ms from _clock_read to the next minute roll-over
+    bool _drawing = false;                // frame in progress, u8g2 is between firstPage() and the last nextPage()
+    unsigned char _drawing_screen = 0;
+    unsigned long _frames = 0;
+    unsigned long _restarts = 0;          // frames dropped half way because the screen changed
+    TaskStats _render_stats;              // us spent drawing pages in one update()
+    TextBuffer<6> _time;  // HH:MM
+    TextBuffer<11> _date; // DD.MM.YYYY
+    Centi _temp_in = 0;
+    Centi _temp_out = 0;
+    Centi _hum_in = 0;
+    Centi _hum_out = 0;
     unsigned char _light_level = 100;
     SoilSensorState _soil_state[3] = {UNINITIALIZED, UNINITIALIZED, UNINITIALIZED};
     unsigned char _water_level = 0;
@@ -59,43 +75,47 @@ private:
     ActuatorDirection _actuator_state = UNKNOWN;
     unsigned char _menuIndex = 0;
     const MenuItem *_curentItem = nullptr;
-    double _value = 0;
-    double _min = 0;
-    double _max = 0;
-    double _step = 0;
+    long _value = 0; // edited setting, TYPE_FLOAT in Centi
+    long _min = 0;
+    long _max = 0;
+    long _step = 0;
 
-    const DataConfig* _curentConfig = nullptr;
+    const Param* _param = nullptr; // edited setting
 
     U8G2_SSD1327_VISIONOX_128X96_1_4W_HW_SPI u8g2;
     void _setTime();
+    void _markDirty(unsigned char screen);
+    void _render();
+    void _drawPage();
     void _showScreen();
     void _showMenu(const MenuItem *item);
-    void _drawStatusLine(int y, const char *label, bool state);
-    void _drawStatusLine(int y, const char *label, ActuatorDirection dir);
+    void _drawLabel(int x, int y, const __FlashStringHelper* text);
+    void _drawStatusLine(int y, const __FlashStringHelper* label, bool state);
+    void _drawStatusLine(int y, const __FlashStringHelper* label, ActuatorDirection dir);
     void _screen1_Clock();
     void _screen2_Climate();
     void _screen3_Soil();
     void _screen4_Water();
     void _screen5_Status();
     void _screen6_Settings(const MenuItem *item);
-    void _screen7_SimpleEditor(String value);
+    void _screen7_SimpleEditor();
+    void _editorValue(TextBuffer<PARAM_VALUE_LENGTH>& text);
 
-    void _getCurrentConfig(const MenuID* id);
-    void _dispScr7();
+    void _dispScr7(const MenuItem* item);
     void _saveConfig(bool exit = false);
     void _changeSrc7(const Direction* direction, const int* position);
     void _encPressed();
     void _encTurned(const Direction* direction, const int* position);
-    void _setDHTIn(const float* temp, const float* hum);
-    void _setDHTOut(const float* temp, const float* hum);
+    void _setDHTIn(const Centi* temp, const Centi* hum);
+    void _setDHTOut(const Centi* temp, const Centi* hum);
     void _setSoil(const unsigned char* chr, const SoilSensorState* state);
     void _setWater(const unsigned char* level);
     void _setLight(const unsigned char* level);
     void _setRelays(const ActuatorDirection* actuator, const bool* led, const bool* heater, const bool* pump);
     static void _wrapperEncPressed(const void* context);
     static void _wrapperEncTurned(const void* context, const Direction* direction, const int* position);
-    static void _wrapperSetDHTIn(const void* context, const float* temp, const float* hum);
-    static void _wrapperSetDHTOut(const void* context, const float* temp, const float* hum);
+    static void _wrapperSetDHTIn(const void* context, const Centi* temp, const Centi* hum);
+    static void _wrapperSetDHTOut(const void* context, const Centi* temp, const Centi* hum);
     static void _wrapperSetSoil(const void* context, const unsigned char* chr, const SoilSensorState* state);
     static void _wrapperSetWater(const void* context, const unsigned char* level);
     static void _wrapperSetLight(const void* context, const unsigned char* level);
@@ -109,82 +129,139 @@ public:
 
     Disp(unsigned char cs, unsigned char rst, unsigned char dc);
     void Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, SoilSensor* soil2, 
-    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays, Enkoder *enkoder, virtuabotixRTC *rtc, Processor* processor);
+    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays, Enkoder *enkoder, virtuabotixRTC *rtc, ParamRegistry* params);
     void update();
+    void printStats(Print* out);
+    void resetStats();
 
     unsigned char brightness(const unsigned char* val);
     unsigned char blankingBrightness(const unsigned char* val);
     unsigned char blankingTime(const unsigned char* time);
     unsigned char screanSwitchTime(const unsigned char* time);
 
+    static void wrapperUpdate(const void* context);
+    static void wrapperStatsCommand(const void* context, Print* out, const char* args);
     static unsigned char wrapperBrightness(const void* context, const unsigned char* val);
     static unsigned char wrapperBlankingBrightness(const void* context, const unsigned char* val);
     static unsigned char wrapperBlankingTime(const void* context, const unsigned char* time);
     static unsigned char wrapperScreanSwitchTime(const void* context, const unsigned char* time);
 };
 
+// Reads the RTC and works out when the next minute starts, so the clock screen reads it once a
+// minute instead of every tick. Only a new minute changes what the clock screen shows.
 void Disp::_setTime()
 {
     _rtc->updateTime();
-    _time = String(_rtc->hours) + ":" + String(_rtc->minutes);
-    _date = String(_rtc->dayofmonth) + "." + String(_rtc->month) + "." + String(_rtc->year);
+    _clock_read = millis();
+    _clock_wait = (_rtc->seconds < 60) ? (60UL - _rtc->seconds) * 1000UL : 60000UL; // bledny odczyt RTC
+    if (_rtc->minutes == _minute) return;
+    _minute = _rtc->minutes;
+    _time.clear().number(_rtc->hours, 2).put(':').number(_rtc->minutes, 2);
+    _date.clear().number(_rtc->dayofmonth, 2).put('.').number(_rtc->month, 2).put('.').number(_rtc->year);
+    _markDirty(1);
 }
 
-void Disp::_showScreen()
+inline void Disp::_markDirty(unsigned char screen)
 {
-    if (_screen_num == 1) _setTime();
-    u8g2.firstPage();
+    _dirty |= DISP_DIRTY(screen);
+}
+
+// Draws the current screen a page at a time, the only place that talks to the display besides
+// the contrast. With the page buffer a frame is 12 pages of 8 rows, each drawn from scratch and sent
+// over SPI; here every update() sends at least one and keeps going only within DISP_PAGE_BUDGET_US,
+// the rest of the frame waits for the next tick so the other tasks are not held up by it.
+// Values changing mid-frame show up in the pages not sent yet and the screen stays dirty, so the
+// next frame fixes any tearing. A switch to another screen starts the frame over.
+void Disp::_render()
+{
+    unsigned long start = micros();
+    if (!_drawing || _drawing_screen != _screen_num)
+    {
+        if (_drawing) _restarts++;
+        _dirty &= ~DISP_DIRTY(_screen_num);
+        _drawing_screen = _screen_num;
+        _drawing = true;
+        u8g2.firstPage();
+    }
     do
     {
-        switch (_screen_num)
+        _drawPage();
+        if (!u8g2.nextPage())
         {
-        case 1:
-            _screen1_Clock();
-            break;
-        case 2:
-            _screen2_Climate();
-            break;
-        case 3:
-            _screen3_Soil();
-            break;
-        case 4:
-            _screen4_Water();
-            break;
-        case 5:
-            _screen5_Status();
+            _drawing = false;
+            _frames++;
             break;
         }
-    } while (u8g2.nextPage());
+    } while (micros() - start < DISP_PAGE_BUDGET_US);
+    _render_stats.record(micros() - start);
+}
+
+void Disp::_drawPage()
+{
+    switch (_screen_num)
+    {
+    case 1:
+        _screen1_Clock();
+        break;
+    case 2:
+        _screen2_Climate();
+        break;
+    case 3:
+        _screen3_Soil();
+        break;
+    case 4:
+        _screen4_Water();
+        break;
+    case 5:
+        _screen5_Status();
+        break;
+    case DISP_MENU_SCREEN:
+        _screen6_Settings(_curentItem);
+        break;
+    case DISP_EDITOR_SCREEN:
+        _screen7_SimpleEditor();
+        break;
+    }
+}
+
+// Switches to _screen_num, drawn by the next update().
+void Disp::_showScreen()
+{
+    if (_screen_num == 1) _setTime();
+    _markDirty(_screen_num);
     _last_switch_time = millis();
 }
 
 void Disp::_showMenu(const MenuItem *item)
 {
-    if(_curentConfig)
+    if(_param)
     {
-        _curentConfig = nullptr;
-        _father = nullptr;
+        _param = nullptr;
         _value = 0;
         _min = 0;
         _max = 0;
         _step = 0;
         _menuIndex = 0;
     }
-    u8g2.firstPage();
-    do
-    {
-        _screen6_Settings(item);
-    } while (u8g2.nextPage());
-    _last_switch_time = millis();
+    _curentItem = item;
+    _screen_num = DISP_MENU_SCREEN;
+    _showScreen();
+}
+
+// drawStr() for texts in flash, the font baseline is at y the same way
+inline void Disp::_drawLabel(int x, int y, const __FlashStringHelper* text)
+{
+    u8g2.setCursor(x, y);
+    u8g2.print(text);
 }
 
-void Disp::_drawStatusLine(int y, const char *label, bool state)
+void Disp::_drawStatusLine(int y, const __FlashStringHelper* label, bool state)
 {
     u8g2.drawFrame(0, y, 128, 15); // Ramka
     u8g2.setFont(u8g2_font_helvB08_tr);
 
     // Nazwa urządzenia po lewej
-    u8g2.drawStr(5, y + 11, label);
+    _drawLabel(5, y + 11, label);
 
     // Status po prawej
     if (state)
@@ -192,23 +269,23 @@ void Disp::_drawStatusLine(int y, const char *label, bool state)
         // Jeśli ON -> Rysujemy czarny kwadrat (Box)
         u8g2.drawBox(70, y, 58, 15);
         u8g2.setDrawColor(0);                 // Zmieniamy kolor pędzla na "gumkę" (czarny)
-        u8g2.drawStr(75, y + 11, "WLACZONE"); // Tekst wycięty w tle
+        _drawLabel(75, y + 11, F("WLACZONE")); // Tekst wycięty w tle
         u8g2.setDrawColor(1);                 // Powrót do normalnego rysowania
     }
     else
     {
         // Jeśli OFF -> Zwykły tekst
-        u8g2.drawStr(85, y + 11, "WYL");
+        _drawLabel(85, y + 11, F("WYL"));
     }
 }
 
-inline void Disp::_drawStatusLine(int y, const char *label, ActuatorDirection dir)
+inline void Disp::_drawStatusLine(int y, const __FlashStringHelper* label, ActuatorDirection dir)
 {
     u8g2.drawFrame(0, y, 128, 15); // Ramka
     u8g2.setFont(u8g2_font_helvB08_tr);
 
     // Nazwa urządzenia po lewej
-    u8g2.drawStr(5, y + 11, label);
+    _drawLabel(5, y + 11, label);
 
     // Status po prawej
     if (dir == OPEN || dir == CLOSE || dir == UNKNOWN)
@@ -216,13 +293,13 @@ inline void Disp::_drawStatusLine(int y, const char *label, ActuatorDirection di
         // Jeśli ON -> Rysujemy czarny kwadrat (Box)
         u8g2.drawBox(70, y, 58, 15);
         u8g2.setDrawColor(0);                 // Zmieniamy kolor pędzla na "gumkę" (czarny)
-        u8g2.drawStr(75, y + 11, MODE_STR[dir + 1]); // Tekst wycięty w tle
+        _drawLabel(75, y + 11, (const __FlashStringHelper*)MODE_STR[dir + 1]); // Tekst wycięty w tle
         u8g2.setDrawColor(1);                 // Powrót do normalnego rysowania
     }
     else
     {
         // Jeśli OFF -> Zwykły tekst
-        u8g2.drawStr(85, y + 11, MODE_STR[dir + 1]);
+        _drawLabel(85, y + 11, (const __FlashStringHelper*)MODE_STR[dir + 1]);
     }
 }
 
@@ -239,7 +316,7 @@ void Disp::_screen1_Clock()
     u8g2.drawStr((128 - w) / 2, 75, _date.c_str());
 
     u8g2.setFont(u8g2_font_helvB08_tr);
-    u8g2.drawStr(50, 20, "CZAS");
+    _drawLabel(50, 20, F("CZAS"));
 }
 
 // --- EKRAN 2: KLIMAT & ŚWIATŁO ---
@@ -247,22 +324,22 @@ void Disp::_screen2_Climate()
 {
     // --- GÓRA: NA ZEWNĄTRZ ---
     u8g2.setFont(u8g2_font_helvB08_tr);
-    u8g2.drawStr(0, 10, "NA ZEWNATRZ:");
+    _drawLabel(0, 10, F("NA ZEWNATRZ:"));
 
     u8g2.setFont(u8g2_font_helvR08_tr);
     u8g2.setCursor(0, 24);
-    u8g2.print("T: ");
-    u8g2.print(_temp_out, 1);
-    u8g2.print("C   ");
-    u8g2.print("W: ");
-    u8g2.print(_hum_out);
-    u8g2.print("%");
+    u8g2.print(F("T: "));
+    printCenti(&u8g2, _temp_out, 1);
+    u8g2.print(F("C   "));
+    u8g2.print(F("W: "));
+    printCenti(&u8g2, _hum_out, 0);
+    u8g2.print('%');
 
     // Pasek światła
     u8g2.setCursor(0, 38);
-    u8g2.print("Swiatlo: ");
+    u8g2.print(F("Swiatlo: "));
     u8g2.print(_light_level);
-    u8g2.print("%");
+    u8g2.print('%');
     u8g2.drawFrame(65, 30, 60, 6);
     u8g2.drawBox(67, 32, (56 * _light_level) / 100, 2);
 
@@ -271,32 +348,32 @@ void Disp::_screen2_Climate()
 
     // --- DÓŁ: SZKLARNIA (OBOK SIEBIE) ---
     u8g2.setFont(u8g2_font_helvB08_tr);
-    u8g2.drawStr(0, 58, "SZKLARNIA (SRODEK):");
+    _drawLabel(0, 58, F("SZKLARNIA (SRODEK):"));
 
     // LEWA STRONA: TEMPERATURA
     u8g2.setFont(u8g2_font_u8glib_4_tf); // Opis mikroskopijną czcionką nad liczbą
-    u8g2.drawStr(10, 70, "TEMP");
+    _drawLabel(10, 70, F("TEMP"));
 
     u8g2.setFont(u8g2_font_ncenB12_tr); // Duża liczba
     u8g2.setCursor(5, 88);
-    u8g2.print(_temp_in, 1);
-    u8g2.print("C");
+    printCenti(&u8g2, _temp_in, 1);
+    u8g2.print('C');
 
     // PRAWA STRONA: WILGOTNOŚĆ
     u8g2.setFont(u8g2_font_u8glib_4_tf); // Opis mikroskopijną czcionką nad liczbą
-    u8g2.drawStr(80, 70, "WILG");
+    _drawLabel(80, 70, F("WILG"));
 
     u8g2.setFont(u8g2_font_ncenB12_tr); // Duża liczba
     u8g2.setCursor(75, 88);
-    u8g2.print(_hum_in);
-    u8g2.print("%");
+    printCenti(&u8g2, _hum_in, 0);
+    u8g2.print('%');
 }
 
 // --- EKRAN 3: GLEBA ---
 void Disp::_screen3_Soil()
 {
     u8g2.setFont(u8g2_font_helvB08_tr);
-    u8g2.drawStr(10, 10, "WILGOTNOSC GLEBY");
+    _drawLabel(10, 10, F("WILGOTNOSC GLEBY"));
 
     // Rysujemy 3 słupki obok siebie
     // Pozycje X dla słupków: 15, 55, 95
@@ -307,18 +384,19 @@ void Disp::_screen3_Soil()
         int h = (_soil_state[i] <= SOIL_WET) ? 46 : (_soil_state[i] <= SOIL_MOIST) ? 25 : 5; // Wysokość wypełnienia
         u8g2.drawBox(17 + 40 * i, (70 - h), 16, h);             // Wypełnienie od dołu
         u8g2.setFont(u8g2_font_helvR08_tr);
-        u8g2.drawStr(18 + 40 * i, 82, ("CZ " + String(i + 1)).c_str()); // Podpis
+        TextBuffer<5> label;
+        u8g2.drawStr(18 + 40 * i, 82, label.textP(PSTR("CZ ")).number(i + 1).c_str()); // Podpis
     }
     // Legenda na samym dole (opcjonalnie)
     // u8g2.setFont(u8g2_font_u8glib_4_tf); // Bardzo mała czcionka (micro)
-    // u8g2.drawStr(15, 95, "MIN          MED          MAX");
+    // _drawLabel(15, 95, F("MIN          MED          MAX"));
 }
 
 // --- EKRAN 4: ZBIORNIK ---
 void Disp::_screen4_Water()
 {
     u8g2.setFont(u8g2_font_helvB08_tr);
-    u8g2.drawStr(45, 12, "ZBIORNIK");
+    _drawLabel(45, 12, F("ZBIORNIK"));
 
     // Rysunek zbiornika
     u8g2.drawFrame(10, 20, 50, 70); // Obrys
@@ -335,27 +413,26 @@ void Disp::_screen4_Water()
     u8g2.setCursor(70, 60);
     u8g2.print(_water_level);
     u8g2.setFont(u8g2_font_ncenB10_tr);
-    u8g2.print("%");
+    u8g2.print('%');
 }
 
 // --- EKRAN 5: STATUS URZĄDZEŃ ---
 void Disp::_screen5_Status()
 {
     u8g2.setFont(u8g2_font_helvB08_tr);
-    u8g2.drawStr(40, 10, "STATUSY");
+    _drawLabel(40, 10, F("STATUSY"));
 
     // Wywołanie pomocnika rysującego paski
-    _drawStatusLine(20, "GRZALKA", _heater_state);
-    _drawStatusLine(45, "KLAPA", _actuator_state);
-    _drawStatusLine(70, "SWIATLO", _LED_state);
+    _drawStatusLine(20, F("GRZALKA"), _heater_state);
+    _drawStatusLine(45, F("KLAPA"), _actuator_state);
+    _drawStatusLine(70, F("SWIATLO"), _LED_state);
 }
 
 void Disp::_screen6_Settings(const MenuItem *item)
 {
-    _curentItem = item;
     // Nagłówek
     u8g2.setFont(u8g2_font_helvB10_tr);
-    u8g2.drawStr(0, 14, item->header);
+    _drawLabel(0, 14, menuHeader(item));
     u8g2.drawLine(0, 16, 128, 16);
 
     // LOGIKA PRZEWIJANIA (VIEWPORT)
@@ -377,7 +454,8 @@ void Disp::_screen6_Settings(const MenuItem *item)
     //int scrollHeight = 78 / item->count; // Wysokość suwaka
     //int scrollY = 18 + (topIndex * (78 - scrollHeight) / (item->count - maxVisible));
     // Prostsza wersja pozycji suwaka (liniowa):
-    int scrollY_simple = 18 + (_menuIndex * 74 / item->count);
+    unsigned char count = menuCount(item);
+    int scrollY_simple = 18 + (_menuIndex * 74 / count);
     u8g2.drawBox(125, scrollY_simple, 2, 6);
 
     // Rysowanie Listy
@@ -388,7 +466,7 @@ void Disp::_screen6_Settings(const MenuItem *item)
         int itemIndex = topIndex + i; // Który to element z tablicy
 
         // Sprawdzamy czy nie wyszliśmy poza tablicę
-        if (itemIndex >= item->count)
+        if (itemIndex >= count)
             break;
 
         int yPos = 18 + (i * 18); // Pozycja Y linii (każda linia ma 18px wysokości)
@@ -401,14 +479,17 @@ void Disp::_screen6_Settings(const MenuItem *item)
         }
 
         // Rysowanie tekstu (x=4 dla marginesu)
-        u8g2.drawStr(4, yPos + 12, item->items[itemIndex]->menuName);
+        _drawLabel(4, yPos + 12, menuName(menuChild(item, itemIndex)));
 
         // Powrót do normalnego koloru
         u8g2.setDrawColor(1);
     }
 }
 
-void Disp::_screen7_SimpleEditor(String value) {
+void Disp::_screen7_SimpleEditor() {
+  TextBuffer<PARAM_VALUE_LENGTH> value;
+  _editorValue(value);
+
   // 1. HEADER (Czarny pasek na górze)
   u8g2.setDrawColor(1);
   u8g2.drawBox(0, 0, 128, 22); // Tło nagłówka (wysokość 22px)
@@ -417,8 +498,10 @@ void Disp::_screen7_SimpleEditor(String value) {
   u8g2.setFont(u8g2_font_helvB10_tr); // Czcionka nagłówka
   
   // Centrowanie Nagłówka
-  int headerW = u8g2.getStrWidth(_curentItem->header);
-  u8g2.drawStr((128 - headerW) / 2, 16, _curentItem->header);
+  TextBuffer<MENU_HEADER_LENGTH> header;
+  header.textP(_curentItem->header);
+  int headerW = u8g2.getStrWidth(header.c_str());
+  u8g2.drawStr((128 - headerW) / 2, 16, header.c_str());
   
   // 2. WARTOŚĆ (Duża czcionka na środku)
   u8g2.setDrawColor(1); // Powrót do normalnego koloru (czarny tekst na białym)
@@ -434,260 +517,32 @@ void Disp::_screen7_SimpleEditor(String value) {
   u8g2.drawStr(xPos, 70, value.c_str());
 }
 
-void Disp::_getCurrentConfig(const MenuID *id)
-{
-    _manual_mode = false;
-    switch (*id)
-    {
-        case ACTUATOR:
-            _curentConfig = &_relays->actuatorConfig;
-            _father = _relays;
-            _manual_mode = true;
-            break;
-        case LED:
-            _curentConfig = &_relays->ledConfig;
-            _father = _relays;
-            _manual_mode = true;
-            break;
-        case PUMP:
-            _curentConfig = &_relays->pumpConfig;
-            _father = _relays;
-            _manual_mode = true;
-            break;
-        case HEATER:
-            _curentConfig = &_relays->heaterConfig;
-            _father = _relays;
-            _manual_mode = true;
-            break;
-        
-        case SWITCHING_DELAY:
-            _curentConfig = &_relays->relayDelayConfig;
-            _father = _relays;
-            break;
-        case SWITCHING_OFF_DELAY:
-            _curentConfig = &_relays->relayOffDelayConfig;
-            _father = _relays;
-            break;
-        
-        case TEMP_SETPOINT:
-            _curentConfig = &_processor->tempSetpointConfig;
-            _father = _processor;
-            break;
-        case TEMP_HYS:
-            _curentConfig = &_processor->tempHysConfig;
-            _father = _processor;
-            break;
-        case HUM_SETPOINT:
-            _curentConfig = &_processor->humSetpointConfig;
-            _father = _processor;
-            break;
-        case HUM_HYS:
-            _curentConfig = &_processor->humHysConfig;
-            _father = _processor;
-            break;
-
-        case PUMP_SENSOR_COUNT:
-            _curentConfig = &_processor->pumpSensorActiveCountConfig;
-            _father = _processor;
-            break;
-        case PUMP_SETPOINT:
-            _curentConfig = &_processor->pumpSetpointConfig;
-            _father = _processor;
-            break;
-        case PUMP_RUN_TIME:
-            _curentConfig = &_processor->pumpRunTimeConfig;
-            _father = _processor;
-            break;
-        case PUMP_RUN_INTERVAL:
-            _curentConfig = &_processor->pumpRunIntervalConfig;
-            _father = _processor;
-            break;
-        
-        case LED_THRESHOLD:
-            _curentConfig = &_processor->ledTresholdConfig;
-            _father = _processor;
-            break;
-        case LED_HYS:
-            _curentConfig = &_processor->ledHysConfig;
-            _father = _processor;
-            break;
-        case LED_RUN_TIME:
-            _curentConfig = &_processor->ledRunTimeConfig;
-            _father = _processor;
-            break;
-        case LED_RUN_INTERVAL:
-            _curentConfig = &_processor->ledRunIntervalConfig;
-            _father = _processor;
-            break;
-
-        case DISPLAY_BRIGHTNESS:
-            _curentConfig = &brightnessConfig;
-            _father = this;
-            break;
-        case DISPLAY_SAVER_BRIGHTNESS:
-            _curentConfig = &blankingBrightnessConfig;
-            _father = this;
-            break;
-        case DISPLAY_SAVER_TIME:
-            _curentConfig = &blankingTimeConfig;
-            _father = this;
-            break;
-        case DISPLAY_SWITCH_TIME:
-            _curentConfig = &screanSwitchTimeConfig;
-            _father = this;
-            break;
-
-        case SENSORS_SOIL1_DELAY:
-            _curentConfig = &_soil[0]->delayConfig;
-            _father = _soil[0];
-            break;
-        case SENSORS_SOIL1_HYS:
-            _curentConfig = &_soil[0]->hysteresisConfig;
-            _father = _soil[0];
-            break;
-        case SENSORS_SOIL2_DELAY:
-            _curentConfig = &_soil[1]->delayConfig;
-            _father = _soil[1];
-            break;
-        case SENSORS_SOIL2_HYS:
-            _curentConfig = &_soil[1]->hysteresisConfig;
-            _father = _soil[1];
-            break;
-        case SENSORS_SOIL3_DELAY:
-            _curentConfig = &_soil[2]->delayConfig;
-            _father = _soil[2];
-            break;
-        case SENSORS_SOIL3_HYS:
-            _curentConfig = &_soil[2]->hysteresisConfig;
-            _father = _soil[2];
-            break;
-        case SENSORS_DHT_IN:
-            _curentConfig = &_dht_in->delayConfig;
-            _father = _dht_in;
-            break;
-        case SENSORS_DHT_OUT:
-            _curentConfig = &_dht_out->delayConfig;
-            _father = _dht_out;
-            break;
-        case SENSORS_WATER:
-            _curentConfig = &_water->delayConfig;
-            _father = _water;
-            break;
-        case SENSORS_PHOTO:
-            _curentConfig = &_light->delayConfig;
-            _father = _light;
-            break;
-        
-        default:
-            _curentConfig = nullptr;
-            _father = nullptr;
-            break;
-    }
-}
-
-void Disp::_dispScr7()
+// Opens the editor for a menu entry that has a setting, the entry becomes the current item.
+void Disp::_dispScr7(const MenuItem* item)
 {
-    _getCurrentConfig(&_curentItem->id);
-    
-    if(_curentConfig)
-    {
-        String str = "";
-        switch (_curentConfig->type)
-        {
-            case TYPE_UCHAR:
-            {
-                _value = _curentConfig->ptr.confUChar->callback(_father, nullptr);
-                _min = _curentConfig->ptr.confUChar->minVal;
-                _max = _curentConfig->ptr.confUChar->maxVal;
-                _step = _curentConfig->ptr.confUChar->step;
-
-                str += String(_curentConfig->ptr.confUChar->callback(_father, nullptr), DEC);
-                str += (_curentConfig->ptr.confUChar->unit[0] != '\0') ? String(" ") + _curentConfig->ptr.confUChar->unit : "";
-                break;
-            }
-            case TYPE_USHORT:
-            {
-                _value = _curentConfig->ptr.confUShort->callback(_father, nullptr);
-                _min = _curentConfig->ptr.confUShort->minVal;
-                _max = _curentConfig->ptr.confUShort->maxVal;
-                _step = _curentConfig->ptr.confUShort->step;
-
-                str += String(_curentConfig->ptr.confUShort->callback(_father, nullptr), DEC);
-                str += (_curentConfig->ptr.confUShort->unit[0] != '\0') ? String(" ") + _curentConfig->ptr.confUShort->unit : "";
-                break;
-            }
-            case TYPE_FLOAT:
-            {
-                _value = _curentConfig->ptr.confFloat->callback(_father, nullptr);
-                _min = _curentConfig->ptr.confFloat->minVal;
-                _max = _curentConfig->ptr.confFloat->maxVal;
-                _step = _curentConfig->ptr.confFloat->step;
-
-                str += String(_curentConfig->ptr.confFloat->callback(_father, nullptr), DEC);
-                str += (_curentConfig->ptr.confFloat->unit[0] != '\0') ? String(" ") + _curentConfig->ptr.confFloat->unit : "";
-                break;
-            }
-            case TYPE_BOOL:
-            {
-                _value = _curentConfig->ptr.confBool->callback(_father, nullptr);
-                _min = 0;
-                _max = 1;
-                _step = 1;
-
-                bool check = _curentConfig->ptr.confBool->callback(_father, nullptr);
-                str += (check) ? _curentConfig->ptr.confBool->txtOn : _curentConfig->ptr.confBool->txtOff;
-                break;
-            }
-            case TYPE_ENUM:
-            {
-                _value = _curentConfig->ptr.confEnum->callback(_father, nullptr);
-                _min = 0;
-                _max = _curentConfig->ptr.confEnum->maxVal;
-                _step = 1;
-
-                short chr =  _curentConfig->ptr.confEnum->callback(_father, nullptr);
-                str += _curentConfig->ptr.confEnum->options[chr];
-                break;
-            }
-        }
-        u8g2.firstPage();
-        do
-        {
-            _screen7_SimpleEditor(str);
-        } while (u8g2.nextPage());
-    }
+    const Param* param = _params->get(menuId(item));
+    if(!param) return;
+    _param = param;
+    _curentItem = item;
+    _value = _params->read(_param);
+    _params->limits(_param, &_min, &_max, &_step);
+    _screen_num = DISP_EDITOR_SCREEN;
+    _markDirty(DISP_EDITOR_SCREEN);
 }
 
 void Disp::_saveConfig(bool exit)
 {
-    if(_curentConfig)
-    {
-        switch (_curentConfig->type)
-        {
-            case TYPE_UCHAR:
-                _curentConfig->ptr.confUChar->callback(_father, (unsigned char*)&_value);
-                break;
-            case TYPE_USHORT:
-                _curentConfig->ptr.confUShort->callback(_father, (unsigned short*)&_value);
-                break;
-            case TYPE_FLOAT:
-                _curentConfig->ptr.confFloat->callback(_father, (float*)&_value);
-                break;
-            case TYPE_BOOL:
-                if(exit) _value = 0;
-                _curentConfig->ptr.confBool->callback(_father, (bool*)&_value);
-                break;
-            case TYPE_ENUM:
-                _curentConfig->ptr.confEnum->callback(_father, (short*)&_value);
-                break;
-        }
-    }
+    if(!_param) return;
+    if(exit && (paramFlags(_param) & PARAM_LIVE) && paramConfig(_param)->type == TYPE_BOOL) _value = 0;
+    _params->write(_param, _value);
+    if(exit) _params->commit(_param);
 }
 
 void Disp::_changeSrc7(const Direction *direction, const int *position)
 {
-    if(_curentConfig && position && position != 0)
+    if(_param && position && position != 0)
     {
+        long before = _value;
         int pos = *position;
         int f = (pos > 0) ? -1 : 1;
         while (pos != 0)
@@ -703,55 +558,34 @@ void Disp::_changeSrc7(const Direction *direction, const int *position)
                 _value = _max;
             }
         }
+        if(_value != before) _markDirty(DISP_EDITOR_SCREEN);
     }
-    String str = "";
-    switch (_curentConfig->type)
-    {
-        case TYPE_UCHAR:
-            str += String(_value, 0);
-            str += (_curentConfig->ptr.confUChar->unit[0] != '\0') ? String(" ") + _curentConfig->ptr.confUChar->unit : "";
-            break;
-        case TYPE_USHORT:
-            str += String(_value, 0);
-            str += (_curentConfig->ptr.confUShort->unit[0] != '\0') ? String(" ") + _curentConfig->ptr.confUShort->unit : "";
-            break;
-        case TYPE_FLOAT:
-            str += String(_value, 1);
-            str += (_curentConfig->ptr.confFloat->unit[0] != '\0') ? String(" ") + _curentConfig->ptr.confFloat->unit : "";
-            break;
-        case TYPE_BOOL:
-            str += (_value != 0) ? _curentConfig->ptr.confBool->txtOn : _curentConfig->ptr.confBool->txtOff;
-            break;
-        case TYPE_ENUM:
-            str += _curentConfig->ptr.confEnum->options[(int)_value];
-            break;
-    }
-    u8g2.firstPage();
-    do
-    {
-        _screen7_SimpleEditor(str);
-    } while (u8g2.nextPage());
     _last_switch_time = millis();
     
-    if(_manual_mode) _saveConfig();
+    if(_param && (paramFlags(_param) & PARAM_LIVE)) _saveConfig();
+}
+
+void Disp::_editorValue(TextBuffer<PARAM_VALUE_LENGTH>& text)
+{
+    _params->format(_param, _value, text);
 }
 
 void Disp::_encPressed()
 {
     _blanking_start = millis();
+    _blanked = false;
     u8g2.setContrast(_brightness);
     if (!_curentItem)
     {
-        _screen_num = 6;
         _showMenu(&mainMenu);
     }
     else
     {
-        if(_curentItem->items)
+        if(menuItems(_curentItem))
         {
             if(_menuIndex == 0)
             {
-                if (_curentItem->parent) _showMenu(_curentItem->parent);
+                if (menuParent(_curentItem)) _showMenu(menuParent(_curentItem));
                 else
                 {
                     _curentItem = nullptr;
@@ -759,14 +593,13 @@ void Disp::_encPressed()
                     _showScreen();
                 }
             }
-            else if(_curentItem->items[_menuIndex]->items) _showMenu(_curentItem->items[_menuIndex]);
-            else _dispScr7();
+            else if(menuItems(menuChild(_curentItem, _menuIndex))) _showMenu(menuChild(_curentItem, _menuIndex));
+            else _dispScr7(menuChild(_curentItem, _menuIndex));
         }
         else
         {
-            if(_curentItem->id == PUMP_SETPOINT) _value = 250 + _value * 40;
             _saveConfig(true);
-            _showMenu(_curentItem->parent);
+            _showMenu(menuParent(_curentItem));
         }
     }
 }
@@ -774,66 +607,83 @@ void Disp::_encPressed()
 void Disp::_encTurned(const Direction *direction, const int *position)
 {
     _blanking_start = millis();
+    _blanked = false;
     u8g2.setContrast(_brightness);
     if (!_curentItem)
     {
         _turned = true;
         _screen_num++;
-        if (_screen_num > 5)
+        if (_screen_num > DISP_SCREENS)
             _screen_num = 1;
         _showScreen();
     }
-    else if (_curentItem->count > 0)
+    else if (menuCount(_curentItem) > 0)
     {
+        unsigned char index = _menuIndex;
         if(*direction == RIGHT)
         {
             _menuIndex++;
-            if(_menuIndex >= _curentItem->count)
+            if(_menuIndex >= menuCount(_curentItem))
                 _menuIndex = 0;
         }
         else
         {
-            if (_menuIndex == 0) _menuIndex = _curentItem->count - 1;
+            if (_menuIndex == 0) _menuIndex = menuCount(_curentItem) - 1;
             else _menuIndex--;
         }
-        _showMenu(_curentItem);
+        // several steps between two updates end up in one frame
+        if (_menuIndex != index) _markDirty(DISP_MENU_SCREEN);
+        _last_switch_time = millis();
     }
     else _changeSrc7(direction, position);
 }
 
-inline void Disp::_setDHTIn(const float *temp, const float *hum)
+// setters only mark the screen that shows the value, update() redraws it if it is on
+inline void Disp::_setDHTIn(const Centi *temp, const Centi *hum)
 {
+    if (_temp_in == *temp && _hum_in == *hum) return;
     _temp_in = *temp;
     _hum_in = *hum;
+    _markDirty(2);
 }
 
-inline void Disp::_setDHTOut(const float *temp, const float *hum)
+inline void Disp::_setDHTOut(const Centi *temp, const Centi *hum)
 {
+    if (_temp_out == *temp && _hum_out == *hum) return;
     _temp_out = *temp;
     _hum_out = *hum;
+    _markDirty(2);
 }
 
 inline void Disp::_setSoil(const unsigned char *chr, const SoilSensorState *state)
 {
+    if (_soil_state[*chr] == *state) return;
     _soil_state[*chr] = *state;
+    _markDirty(3);
 }
 
 inline void Disp::_setWater(const unsigned char *level)
 {
+    if (_water_level == *level) return;
     _water_level = *level;
+    _markDirty(4);
 }
 
 inline void Disp::_setLight(const unsigned char *level)
 {
+    if (_light_level == *level) return;
     _light_level = *level;
+    _markDirty(2);
 }
 
 inline void Disp::_setRelays(const ActuatorDirection *actuator, const bool *led, const bool *heater, const bool *pump)
 {
+    if (_actuator_state == *actuator && _LED_state == *led && _heater_state == *heater) return;
     _actuator_state = *actuator;
     _LED_state = *led;
     _heater_state = *heater;
     //_pump_state = *pump;
+    _markDirty(5);
 }
 
 void Disp::_wrapperEncPressed(const void *context)
@@ -848,13 +698,13 @@ void Disp::_wrapperEncTurned(const void *context, const Direction *direction, co
     return obj->_encTurned(direction, position);
 }
 
-inline void Disp::_wrapperSetDHTIn(const void *context, const float *temp, const float *hum)
+inline void Disp::_wrapperSetDHTIn(const void *context, const Centi *temp, const Centi *hum)
 {
     Disp* obj = (Disp*)context;
     return obj->_setDHTIn(temp, hum);
 }
 
-inline void Disp::_wrapperSetDHTOut(const void *context, const float *temp, const float *hum)
+inline void Disp::_wrapperSetDHTOut(const void *context, const Centi *temp, const Centi *hum)
 {
     Disp* obj = (Disp*)context;
     return obj->_setDHTOut(temp, hum);
@@ -885,10 +735,10 @@ inline void Disp::_wrapperSetRelays(const void *context, const ActuatorDirection
     return obj->_setRelays(actuator, led, heater, pump);
 }
 
-Disp::Disp(unsigned char cs, unsigned char rst, unsigned char dc) : u8g2(U8G2_R0, cs, dc, rst) {}
+Disp::Disp(unsigned char cs, unsigned char rst, unsigned char dc) : u8g2(U8G2_R0, cs, dc, rst) { resetStats(); }
 
 void Disp::Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, SoilSensor* soil2, 
-    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays, Enkoder *enkoder, virtuabotixRTC *rtc, Processor* processor)
+    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays, Enkoder *enkoder, virtuabotixRTC *rtc, ParamRegistry* params)
 {
     _dht_in = dhtIn;
     _dht_out = dhtOut;
@@ -900,7 +750,7 @@ void Disp::Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, SoilSens
     _relays = relays;
     _enkoder = enkoder;
     _rtc = rtc;
-    _processor = processor;
+    _params = params;
     u8g2.begin();
     u8g2.setContrast(_brightness);
     _enkoder->addButtonCallback(this, _wrapperEncPressed);
@@ -913,22 +763,23 @@ void Disp::Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, SoilSens
     _water->addCallback(this, _wrapperSetWater);
     _light->addCallback(this, _wrapperSetLight);
     _relays->addCallback(this, _wrapperSetRelays);
-    Serial.println("Display initialized.");
+    Serial.println(F("Display initialized."));
 }
 
 void Disp::update()
 {
-    if(millis() - _blanking_start >= _blanking_time * 60 * 1000) {
+    if(!_blanked && millis() - _blanking_start >= 60000UL * _blanking_time) {
         u8g2.setContrast(_blanking_brightness);
+        _blanked = true;
     }
 
     unsigned long requiredDelay = (_turned) ? (1000UL * _back_to_switching_time) : (1000UL * _screan_switch_time);
 
-    if (!_curentItem && (millis() - _last_switch_time > requiredDelay))
+    if (!_curentItem && (_turned || _screan_switch_time) && (millis() - _last_switch_time > requiredDelay))
     {
         _turned = false;
         _screen_num++;
-        if (_screen_num > 5)
+        if (_screen_num > DISP_SCREENS || !_screan_switch_time)
             _screen_num = 1;
         _showScreen();
     }
@@ -938,17 +789,50 @@ void Disp::update()
         _curentItem = nullptr;
         _showScreen();
     }
+    else if (_screen_num == 1 && millis() - _clock_read >= _clock_wait) _setTime();
+
+    if (_drawing || (_dirty & DISP_DIRTY(_screen_num))) _render();
+}
+
+void Disp::printStats(Print* out)
+{
+    out->print(F("frames="));
+    out->print(_frames);
+    out->print(F(" restarts="));
+    out->print(_restarts);
+    out->print(F(" screen="));
+    out->print(_screen_num);
+    out->print(F(" dirty="));
+    out->println(_dirty, BIN);
+    _render_stats.print(out, F("render"));
+    out->println();
+}
+
+void Disp::resetStats()
+{
+    _frames = 0;
+    _restarts = 0;
+    _render_stats.reset();
 }
 
+// Both apply at once when they are the contrast of the current state, e.g. when loaded at boot
 inline unsigned char Disp::brightness(const unsigned char *val)
 {
-    if (val) _brightness = *val;
+    if (val)
+    {
+        _brightness = *val;
+        if (!_blanked) u8g2.setContrast(_brightness);
+    }
     return _brightness;
 }
 
 inline unsigned char Disp::blankingBrightness(const unsigned char *val)
 {
-    if (val) _blanking_brightness = *val;
+    if (val)
+    {
+        _blanking_brightness = *val;
+        if (_blanked) u8g2.setContrast(_blanking_brightness);
+    }
     return _blanking_brightness;
 }
 
@@ -964,6 +848,24 @@ inline unsigned char Disp::screanSwitchTime(const unsigned char *time)
     return _screan_switch_time;
 }
 
+void Disp::wrapperUpdate(const void *context)
+{
+    Disp* obj = (Disp*)context;
+    obj->update();
+}
+
+// "disp" prints frame counters and the per-tick render time, "disp reset" clears them
+void Disp::wrapperStatsCommand(const void *context, Print *out, const char *args)
+{
+    Disp* obj = (Disp*)context;
+    if (strcmp_P(args, PSTR("reset")) == 0)
+    {
+        obj->resetStats();
+        out->println(F("disp reset"));
+    }
+    else obj->printStats(out);
+}
+
 unsigned char Disp::wrapperBrightness(const void *context, const unsigned char *val)
 {
     Disp* obj = (Disp*)context;
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <avr/eeprom.h>
+
+// EEPROM split: settings records from address 0, points spilled by the TelemetryQueue above them.
+// 0 for EEPROM_TELEMETRY_SIZE keeps the queue in SRAM only. Moving the split makes settings records
+// saved above it unreachable, the store then falls back to the newest one below.
+#define EEPROM_TELEMETRY_SIZE 1024
+#define EEPROM_SETTINGS_SIZE (E2END + 1 - EEPROM_TELEMETRY_SIZE)
+#define EEPROM_TELEMETRY_START EEPROM_SETTINGS_SIZE
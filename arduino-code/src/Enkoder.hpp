@@ -1,9 +1,14 @@
 #pragma once
 
-#include <ArduinoSTL.h>
+#include "Observers.hpp"
+#include "FastPin.hpp"
 
+#define ENCODER_CLK_PIN 3 // INT5
+#define ENCODER_DT_PIN 34
+#define ENCODER_SW_PIN 2 // INT4
 #define ENKODER_TIMEOUT 1000 //ms
 #define BUTTON_DEBOUNCE_DELAY 200 //ms
+#define ENKODER_OBSERVERS 1 // display
 
 enum Direction{
     LEFT,
@@ -17,12 +22,9 @@ using EnkoderTurnedCallback = void (*)(const void*, const Direction*, const int*
 class Enkoder
 {
 private:
-    std::vector<std::pair<const void*, EnkoderBtCallback>> _btCallbacks;
-    std::vector<std::pair<const void*, EnkoderTurnedCallback>> _turnedCallbacks;
+    Observers<EnkoderBtCallback, ENKODER_OBSERVERS> _btCallbacks;
+    Observers<EnkoderTurnedCallback, ENKODER_OBSERVERS> _turnedCallbacks;
 
-    unsigned char _pin_CLK;
-    unsigned char _pin_DT;
-    unsigned char _pin_SW;
     volatile int _position = 0;
     volatile Direction _direction;
     volatile unsigned long _lastEncChange = 0;
@@ -38,12 +40,12 @@ private:
     static void _wrapperDoButton();
 
 public:
-    Enkoder(unsigned char pin_CLK, unsigned char pin_DT, unsigned char pin_SW);
+    Enkoder();
 
     ~Enkoder()
     {
-        detachInterrupt(digitalPinToInterrupt(_pin_CLK));
-        detachInterrupt(digitalPinToInterrupt(_pin_SW));
+        detachInterrupt(digitalPinToInterrupt(ENCODER_CLK_PIN));
+        detachInterrupt(digitalPinToInterrupt(ENCODER_SW_PIN));
     }
 
     void Init();
@@ -52,6 +54,8 @@ public:
     void addTurnedCallback(const void* context, EnkoderTurnedCallback callback);
 
     void loop();
+
+    static void wrapperLoop(const void* context);
 };
 
 void Enkoder::_doButton()
@@ -66,7 +70,7 @@ void Enkoder::_doButton()
 void Enkoder::_doEncoder()
 {
         //if(millis() - _lastEncChange >= ENKODER_TIMEOUT) _position = 0;
-        if (digitalRead(_pin_CLK) != digitalRead(_pin_DT)) {
+        if (FastPin<ENCODER_CLK_PIN>::read() != FastPin<ENCODER_DT_PIN>::read()) {
             _direction = RIGHT;
             _position++; 
         } else {
@@ -89,24 +93,21 @@ void Enkoder::_doEncoder()
 
 Enkoder* Enkoder::_instance = nullptr;
 
-Enkoder::Enkoder(unsigned char pin_CLK, unsigned char pin_DT, unsigned char pin_SW)
+Enkoder::Enkoder()
 {
-    _pin_CLK = pin_CLK;
-    _pin_DT = pin_DT;
-    _pin_SW = pin_SW;
     _instance = this;
 }
 
 void Enkoder::Init()
 {
-    pinMode(_pin_CLK, INPUT_PULLUP);
-    pinMode(_pin_DT, INPUT_PULLUP);
-    pinMode(_pin_SW, INPUT_PULLUP);
+    FastPin<ENCODER_CLK_PIN>::input(true);
+    FastPin<ENCODER_DT_PIN>::input(true);
+    FastPin<ENCODER_SW_PIN>::input(true);
 
-    attachInterrupt(digitalPinToInterrupt(_pin_CLK), Enkoder::_wrapperDoEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(_pin_SW), Enkoder::_wrapperDoButton, FALLING);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_CLK_PIN), Enkoder::_wrapperDoEncoder, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_SW_PIN), Enkoder::_wrapperDoButton, FALLING);
 
-    Serial.println("Enkoder initialized");
+    Serial.println(F("Enkoder initialized"));
 }
 
 int Enkoder::getEncPos()
@@ -117,12 +118,12 @@ int Enkoder::getEncPos()
 
 void Enkoder::addButtonCallback(const void *context, EnkoderBtCallback callback)
 {
-    _btCallbacks.push_back(std::make_pair(context, callback));
+    _btCallbacks.add(context, callback);
 }
 
 void Enkoder::addTurnedCallback(const void *context, EnkoderTurnedCallback callback)
 {
-    _turnedCallbacks.push_back(std::make_pair(context, callback));
+    _turnedCallbacks.add(context, callback);
 }
 
 void Enkoder::loop()
@@ -132,21 +133,21 @@ void Enkoder::loop()
         _encChanged = false;
         Direction d = _direction;
         int p = _position;
-        for (const auto &callback : _turnedCallbacks)
-        {
-            callback.second(callback.first, &d, &p);
-        }
+        _turnedCallbacks.notify(&d, &p);
         _position = 0;
-        Serial.print("Encoder turned:");
+        Serial.print(F("Encoder turned:"));
         Serial.println(p);
     }   
     if(_btnChanged)
     {
         _btnChanged = false;
-        for (const auto &callback : _btCallbacks)
-        {
-            callback.second(callback.first);
-        }
-        Serial.println("Encoder button pressed");
+        _btCallbacks.notify();
+        Serial.println(F("Encoder button pressed"));
     }
 }
+
+void Enkoder::wrapperLoop(const void *context)
+{
+    Enkoder* obj = (Enkoder*)context;
+    obj->loop();
+}
\ No newline at end of file
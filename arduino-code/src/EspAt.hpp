@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define ESP_AT_READ 64  // bytes of an answer read per poll() at most
+#define ESP_AT_LINE 24  // answer lines are cut to this, long enough for every line told apart
+
+// How far the answer to a raw AT command got
+enum AtReply : unsigned char
+{
+    AT_PENDING,
+    AT_OK,      // "OK" or "SEND OK"
+    AT_FAIL,    // "FAIL", "ERROR" or "SEND FAIL"
+    AT_PROMPT,  // "> ", AT+CIPSEND takes the data now
+    AT_LINE,    // any other line, see line()
+    AT_TIMEOUT  // no final answer in time
+};
+
+// One raw AT exchange with the ESP8266: the owner writes the command after start() and
+// poll()s the answer from its following updates, so nothing waits on the module.
+// The WiFiEsp library would block in every exchange until the answer or its timeout.
+// Lines that are not a final answer come back as AT_LINE, one per poll() call:
+//   while ((reply = _at.poll(timeout)) == AT_LINE) parse(_at.line());
+class EspAt
+{
+private:
+    Stream* _serial = nullptr;
+    char _line[ESP_AT_LINE];
+    unsigned char _length = 0;
+    bool _busy = false;
+    unsigned long _since = 0;
+
+public:
+    void Init(Stream* serial);
+    Stream* serial();
+    void start();
+    void wait();
+    void done();
+    bool busy();
+    AtReply poll(unsigned long timeout);
+    const char* line();
+};
+
+inline void EspAt::Init(Stream* serial)
+{
+    _serial = serial;
+    _line[0] = '\0';
+}
+
+inline Stream* EspAt::serial() { return _serial; }
+
+// Before writing a command: drop what the module said unasked, start timing the answer
+void EspAt::start()
+{
+    for (unsigned char i = 0; i < ESP_AT_READ && _serial->available(); i++) _serial->read();
+    wait();
+}
+
+// Times the next answer of the running exchange, what already arrived stays
+void EspAt::wait()
+{
+    _length = 0;
+    _busy = true;
+    _since = millis();
+}
+
+inline void EspAt::done() { _busy = false; }
+
+// true from start() until done(), the command is out and its answer not handled yet
+inline bool EspAt::busy() { return _busy; }
+
+// Reads what has arrived of the answer, line by line, without waiting for more
+AtReply EspAt::poll(unsigned long timeout)
+{
+    for (unsigned char i = 0; i < ESP_AT_READ && _serial->available(); i++)
+    {
+        char c = _serial->read();
+        if (c == '\r') continue;
+        if (c == '>' && _length == 0) return AT_PROMPT;
+        if (c != '\n')
+        {
+            if (_length < ESP_AT_LINE - 1) _line[_length++] = c;
+            continue;
+        }
+        if (_length == 0) continue; // the empty line before a final answer
+        _line[_length] = '\0';
+        _length = 0;
+        if (!strcmp_P(_line, PSTR("OK")) || !strcmp_P(_line, PSTR("SEND OK"))) return AT_OK;
+        if (!strcmp_P(_line, PSTR("FAIL")) || !strcmp_P(_line, PSTR("ERROR")) || !strcmp_P(_line, PSTR("SEND FAIL"))) return AT_FAIL;
+        return AT_LINE;
+    }
+    return (millis() - _since >= timeout) ? AT_TIMEOUT : AT_PENDING;
+}
+
+inline const char* EspAt::line() { return _line; }
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Observers.hpp"
+#include "TaskStats.hpp"
+
+#define EVENT_QUEUE_LENGTH 8 // more than one event per sensor, a full queue means dispatch is stuck
+#define EVENT_OBSERVERS 1    // processor
+
+enum EventType : unsigned char
+{
+    EVENT_DHT_IN,
+    EVENT_SOIL,
+    EVENT_LIGHT,
+    EVENT_WATER,
+    EVENT_TYPES
+};
+
+struct Event
+{
+    EventType type;
+    unsigned char source; // which sensor of the type (soil probe id), 0 otherwise
+    short value[2];       // payload, meaning depends on the type
+    unsigned long posted; // us, first post of a coalesced event
+};
+
+using EventCallback = void (*)(const void*, const Event*);
+using EventsDrainedCallback = void (*)(const void*);
+
+// Bounded queue between sensor callbacks and the control logic. post() only stores the event,
+// dispatch() runs as its own task and hands the queued events to the handlers, then tells the
+// drained observers once, so a burst of changes ends in a single evaluation.
+// An event of the same type and source that is still queued is overwritten (latest value wins).
+// Events posted while dispatching wait for the next tick, handlers never nest.
+// Not for use from interrupts.
+class EventQueue
+{
+private:
+    Event _ring[EVENT_QUEUE_LENGTH];
+    unsigned char _head = 0;
+    unsigned char _count = 0;
+
+    unsigned long _posted = 0;
+    unsigned long _coalesced = 0;
+    unsigned long _dropped = 0;
+    unsigned char _max_depth = 0;
+    TaskStats _latency[EVENT_TYPES]; // us from post to dispatch
+
+    Observers<EventCallback, EVENT_OBSERVERS> _handlers;
+    Observers<EventsDrainedCallback, EVENT_OBSERVERS> _drained;
+
+    static const __FlashStringHelper* _typeName(EventType type);
+
+public:
+    EventQueue();
+    void addHandler(const void* context, EventCallback callback);
+    void addDrainedCallback(const void* context, EventsDrainedCallback callback);
+
+    bool post(EventType type, unsigned char source, short value0, short value1 = 0);
+    void dispatch();
+
+    void printStats(Print* out);
+    void resetStats();
+
+    static void wrapperDispatch(const void* context);
+    static void wrapperStatsCommand(const void* context, Print* out, const char* args);
+};
+
+EventQueue::EventQueue() { resetStats(); }
+
+inline void EventQueue::addHandler(const void* context, EventCallback callback) { _handlers.add(context, callback); }
+
+inline void EventQueue::addDrainedCallback(const void* context, EventsDrainedCallback callback) { _drained.add(context, callback); }
+
+// Returns false if the queue is full and the event was lost.
+bool EventQueue::post(EventType type, unsigned char source, short value0, short value1)
+{
+    _posted++;
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        Event& queued = _ring[(_head + i) % EVENT_QUEUE_LENGTH];
+        if (queued.type == type && queued.source == source)
+        {
+            queued.value[0] = value0;
+            queued.value[1] = value1;
+            _coalesced++;
+            return true;
+        }
+    }
+    if (_count >= EVENT_QUEUE_LENGTH)
+    {
+        _dropped++;
+        return false;
+    }
+    Event& event = _ring[(_head + _count) % EVENT_QUEUE_LENGTH];
+    event.type = type;
+    event.source = source;
+    event.value[0] = value0;
+    event.value[1] = value1;
+    event.posted = micros();
+    _count++;
+    if (_count > _max_depth) _max_depth = _count;
+    return true;
+}
+
+void EventQueue::dispatch()
+{
+    unsigned char pending = _count;
+    if (!pending) return;
+    while (pending--)
+    {
+        Event event = _ring[_head];
+        _head = (_head + 1) % EVENT_QUEUE_LENGTH;
+        _count--;
+        _latency[event.type].record(micros() - event.posted);
+        _handlers.notify(&event);
+    }
+    _drained.notify();
+}
+
+const __FlashStringHelper* EventQueue::_typeName(EventType type)
+{
+    switch (type)
+    {
+    case EVENT_DHT_IN: return F("dht_in");
+    case EVENT_SOIL: return F("soil");
+    case EVENT_LIGHT: return F("light");
+    case EVENT_WATER: return F("water");
+    default: return F("?");
+    }
+}
+
+void EventQueue::printStats(Print* out)
+{
+    out->print(F("posted="));
+    out->print(_posted);
+    out->print(F(" coalesced="));
+    out->print(_coalesced);
+    out->print(F(" dropped="));
+    out->print(_dropped);
+    out->print(F(" depth="));
+    out->print(_count);
+    out->print('/');
+    out->println(_max_depth);
+    for (unsigned char i = 0; i < EVENT_TYPES; i++)
+    {
+        _latency[i].print(out, _typeName((EventType)i));
+        out->println();
+    }
+}
+
+void EventQueue::resetStats()
+{
+    _posted = 0;
+    _coalesced = 0;
+    _dropped = 0;
+    _max_depth = _count;
+    for (unsigned char i = 0; i < EVENT_TYPES; i++) _latency[i].reset();
+}
+
+void EventQueue::wrapperDispatch(const void* context)
+{
+    EventQueue* obj = (EventQueue*)context;
+    obj->dispatch();
+}
+
+// "events" prints counters and post-to-dispatch latency per type, "events reset" clears them
+void EventQueue::wrapperStatsCommand(const void* context, Print* out, const char* args)
+{
+    EventQueue* obj = (EventQueue*)context;
+    if (strcmp_P(args, PSTR("reset")) == 0)
+    {
+        obj->resetStats();
+        out->println(F("events reset"));
+    }
+    else obj->printStats(out);
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Digital pin with the port and bit resolved by the compiler. digitalWrite()/digitalRead() look both
+// up in flash tables and check for PWM on every call (~50-60 cycles); here a write to ports A-G is a
+// single sbi/cbi and a read a single sbic/sbis, ports H-L take a few instructions with interrupts
+// off, since their registers are out of sbi/cbi range and the update is a read-modify-write.
+//   FastPin<RELAY_PUMP_PIN>::output();
+//   FastPin<RELAY_PUMP_PIN>::write(true);
+// Only the ATmega1280/2560 (Mega) pin map is known. On other targets and on the host it falls back
+// to the Arduino API, so the simulator still sees every access.
+template <unsigned char N>
+class FastPin
+{
+public:
+    static void output();
+    static void input(bool pullup = false);
+    static void write(bool high);
+    static bool read();
+};
+
+#define FAST_PIN_BATCH_PORTS 2 // distinct ports one batch can hold, further ones are written directly
+#define FAST_PIN_BATCH_PINS 8  // host only
+
+// Collects pin writes and applies them in commit() with one write per port, so outputs that
+// change together also switch together.
+//   FastPinBatch batch;
+//   batch.write<RELAY_PUMP_PIN>(false);
+//   batch.write<RELAY_LED_PIN>(true);
+//   batch.commit();
+class FastPinBatch
+{
+private:
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+    unsigned short _port[FAST_PIN_BATCH_PORTS]; // PORTx address
+    unsigned char _set[FAST_PIN_BATCH_PORTS];
+    unsigned char _clear[FAST_PIN_BATCH_PORTS];
+#else
+    unsigned char _pin[FAST_PIN_BATCH_PINS];
+    bool _high[FAST_PIN_BATCH_PINS];
+#endif
+    unsigned char _count = 0;
+
+public:
+    template <unsigned char N>
+    void write(bool high);
+    void commit();
+};
+
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+
+// Mega pin -> PINx register address (DDRx is +1, PORTx +2), same map as pins_arduino.h
+constexpr unsigned short fastPinRegister(unsigned char pin)
+{
+    return (pin <= 1 || pin == 2 || pin == 3 || pin == 5) ? 0x2C                 // E
+         : (pin == 4 || (pin >= 39 && pin <= 41)) ? 0x32                          // G
+         : ((pin >= 6 && pin <= 9) || pin == 16 || pin == 17) ? 0x100             // H
+         : ((pin >= 10 && pin <= 13) || (pin >= 50 && pin <= 53)) ? 0x23          // B
+         : (pin == 14 || pin == 15) ? 0x103                                       // J
+         : ((pin >= 18 && pin <= 21) || pin == 38) ? 0x29                         // D
+         : (pin >= 22 && pin <= 29) ? 0x20                                        // A
+         : (pin >= 30 && pin <= 37) ? 0x26                                        // C
+         : (pin >= 42 && pin <= 49) ? 0x109                                       // L
+         : (pin >= 54 && pin <= 61) ? 0x2F                                        // F (A0-A7)
+         : (pin >= 62 && pin <= 69) ? 0x106                                       // K (A8-A15)
+         : 0;
+}
+
+constexpr unsigned char fastPinBit(unsigned char pin)
+{
+    return (pin <= 1) ? pin
+         : (pin == 2 || pin == 3) ? pin + 2
+         : (pin == 4) ? 5
+         : (pin == 5) ? 3
+         : (pin >= 6 && pin <= 9) ? pin - 3
+         : (pin >= 10 && pin <= 13) ? pin - 6
+         : (pin == 14) ? 1
+         : (pin == 15) ? 0
+         : (pin == 16) ? 1
+         : (pin == 17) ? 0
+         : (pin >= 18 && pin <= 21) ? 21 - pin
+         : (pin >= 22 && pin <= 29) ? pin - 22
+         : (pin >= 30 && pin <= 37) ? 37 - pin
+         : (pin == 38) ? 7
+         : (pin >= 39 && pin <= 41) ? 41 - pin
+         : (pin >= 42 && pin <= 49) ? 49 - pin
+         : (pin >= 50 && pin <= 53) ? 53 - pin
+         : (pin >= 54 && pin <= 69) ? (pin - 54) % 8
+         : 0;
+}
+
+#define FAST_PIN_REG(offset) (*(volatile unsigned char*)(fastPinRegister(N) + (offset)))
+#define FAST_PIN_MASK ((unsigned char)(1 << fastPinBit(N)))
+#define FAST_PIN_SBI_RANGE (fastPinRegister(N) + 2 < 0x40) // PORTx reachable by sbi/cbi
+
+// read-modify-write of one bit, atomic on every port
+#define FAST_PIN_SET(offset, on)                                          \
+    do                                                                    \
+    {                                                                     \
+        if (FAST_PIN_SBI_RANGE)                                           \
+        {                                                                 \
+            if (on) FAST_PIN_REG(offset) |= FAST_PIN_MASK;                \
+            else FAST_PIN_REG(offset) &= ~FAST_PIN_MASK;                  \
+        }                                                                 \
+        else                                                              \
+        {                                                                 \
+            unsigned char sreg = SREG;                                    \
+            cli();                                                        \
+            if (on) FAST_PIN_REG(offset) |= FAST_PIN_MASK;                \
+            else FAST_PIN_REG(offset) &= ~FAST_PIN_MASK;                  \
+            SREG = sreg;                                                  \
+        }                                                                 \
+    } while (0)
+
+template <unsigned char N>
+inline void FastPin<N>::output()
+{
+    static_assert(fastPinRegister(N) != 0, "FastPin: not a Mega digital pin");
+    FAST_PIN_SET(1, true);
+}
+
+template <unsigned char N>
+inline void FastPin<N>::input(bool pullup)
+{
+    static_assert(fastPinRegister(N) != 0, "FastPin: not a Mega digital pin");
+    FAST_PIN_SET(1, false);
+    FAST_PIN_SET(2, pullup);
+}
+
+template <unsigned char N>
+inline void FastPin<N>::write(bool high) { FAST_PIN_SET(2, high); }
+
+template <unsigned char N>
+inline bool FastPin<N>::read() { return FAST_PIN_REG(0) & FAST_PIN_MASK; }
+
+// everything but the value is known at compile time, the slot search folds away for a fixed pin order
+template <unsigned char N>
+inline void FastPinBatch::write(bool high)
+{
+    unsigned char i = 0;
+    while (i < _count && _port[i] != fastPinRegister(N) + 2) i++;
+    if (i == _count)
+    {
+        if (_count >= FAST_PIN_BATCH_PORTS)
+        {
+            FastPin<N>::write(high);
+            return;
+        }
+        _port[i] = fastPinRegister(N) + 2;
+        _set[i] = 0;
+        _clear[i] = 0;
+        _count++;
+    }
+    if (high) _set[i] |= FAST_PIN_MASK;
+    else _clear[i] |= FAST_PIN_MASK;
+}
+
+inline void FastPinBatch::commit()
+{
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        volatile unsigned char* port = (volatile unsigned char*)_port[i];
+        unsigned char sreg = SREG;
+        cli();
+        *port = (*port & ~(_set[i] | _clear[i])) | _set[i];
+        SREG = sreg;
+    }
+    _count = 0;
+}
+
+#undef FAST_PIN_SET
+#undef FAST_PIN_SBI_RANGE
+#undef FAST_PIN_MASK
+#undef FAST_PIN_REG
+
+#else
+
+template <unsigned char N>
+inline void FastPin<N>::output() { pinMode(N, OUTPUT); }
+
+template <unsigned char N>
+inline void FastPin<N>::input(bool pullup) { pinMode(N, pullup ? INPUT_PULLUP : INPUT); }
+
+template <unsigned char N>
+inline void FastPin<N>::write(bool high) { digitalWrite(N, high ? HIGH : LOW); }
+
+template <unsigned char N>
+inline bool FastPin<N>::read() { return digitalRead(N) == HIGH; }
+
+template <unsigned char N>
+inline void FastPinBatch::write(bool high)
+{
+    if (_count >= FAST_PIN_BATCH_PINS)
+    {
+        FastPin<N>::write(high);
+        return;
+    }
+    _pin[_count] = N;
+    _high[_count] = high;
+    _count++;
+}
+
+inline void FastPinBatch::commit()
+{
+    for (unsigned char i = 0; i < _count; i++) digitalWrite(_pin[i], _high[i] ? HIGH : LOW);
+    _count = 0;
+}
+
+#endif
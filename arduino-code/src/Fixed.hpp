@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Fixed point numbers in hundredths ("centi-units"): 24.5 C is 2450, 55 % is 5500.
+// A short covers -327.67..327.67, enough for every temperature, humidity and setting here,
+// and keeps all sensor and control arithmetic in integer instructions (the AVR has no FPU).
+using Centi = short;
+
+#define CENTI_ONE 100
+#define CENTI_NAN ((Centi)-32768) // no valid reading, compares below everything else
+#define CENTI(x) ((Centi)((x) * CENTI_ONE + ((x) < 0 ? -0.5 : 0.5))) // constants only, folded by the compiler
+#define CENTI_FORMAT_LENGTH 8 // "-327.67" + '\0'
+
+inline bool centiValid(Centi value) { return value != CENTI_NAN; }
+
+// Writes value with 0..2 decimals (rounded half away from zero), "nan" for CENTI_NAN.
+char* formatCenti(char* buf, Centi value, unsigned char decimals)
+{
+    if (!centiValid(value))
+    {
+        strcpy(buf, "nan");
+        return buf;
+    }
+    if (decimals > 2) decimals = 2;
+    unsigned short scale = (decimals == 0) ? 100 : (decimals == 1) ? 10 : 1;
+    unsigned short magnitude = (value < 0) ? -(long)value : value;
+    unsigned short rounded = (magnitude + scale / 2) / scale;
+    bool negative = value < 0 && rounded != 0;
+
+    char tmp[CENTI_FORMAT_LENGTH];
+    unsigned char len = 0;
+    for (unsigned char i = 0; i < decimals; i++)
+    {
+        tmp[len++] = '0' + rounded % 10;
+        rounded /= 10;
+    }
+    if (decimals) tmp[len++] = '.';
+    do
+    {
+        tmp[len++] = '0' + rounded % 10;
+        rounded /= 10;
+    } while (rounded);
+
+    char* out = buf;
+    if (negative) *out++ = '-';
+    while (len) *out++ = tmp[--len];
+    *out = '\0';
+    return buf;
+}
+
+// Reads "[-]units[.frac]" with up to 2 decimals, false for anything else or a value out of range.
+bool parseCenti(const char* str, Centi* value)
+{
+    bool negative = (*str == '-');
+    if (negative) str++;
+    long result = 0;
+    unsigned char digits = 0;
+    while (*str >= '0' && *str <= '9')
+    {
+        result = result * 10 + (*str++ - '0');
+        if (++digits > 3) return false;
+    }
+    result *= CENTI_ONE;
+    if (*str == '.')
+    {
+        str++;
+        if (*str >= '0' && *str <= '9') result += 10 * (*str++ - '0');
+        if (*str >= '0' && *str <= '9') result += *str++ - '0';
+    }
+    else if (!digits) return false;
+    if (*str != '\0' || result > 32767) return false;
+    *value = negative ? -result : result;
+    return true;
+}
+
+inline size_t printCenti(Print* out, Centi value, unsigned char decimals)
+{
+    char buf[CENTI_FORMAT_LENGTH];
+    return out->print(formatCenti(buf, value, decimals));
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "EspAt.hpp"
+#include "Observers.hpp"
+#include "TextBuffer.hpp"
+
+#define HTTP_CHUNK 64                //bytes per AT+CIPSEND exchange with the ESP
+#define HTTP_HEADER_LENGTH 160       // request line and headers
+#define HTTP_CONNECT_TIMEOUT 10000   //ms for AT+CIPSTART, the ESP gives up on an unreachable server after ~5 s
+#define HTTP_SEND_TIMEOUT 5000       //ms for the "> " prompt and for SEND OK
+#define HTTP_RESPONSE_TIMEOUT 5000   //ms for the status line
+#define HTTP_CLOSE_TIMEOUT 2000      //ms for AT+CIPCLOSE
+#define HTTP_READ_PER_STEP 32        //bytes of the response looked at per update()
+#define HTTP_OBSERVERS 2
+
+enum HttpState : unsigned char
+{
+    HTTP_IDLE,
+    HTTP_CONNECT,
+    HTTP_HEADERS,
+    HTTP_BODY,
+    HTTP_STATUS,
+    HTTP_CLOSE
+};
+
+enum HttpResult : unsigned char
+{
+    HTTP_DONE,           // status holds the server's answer, 2xx is a success
+    HTTP_CONNECT_FAILED,
+    HTTP_SEND_FAILED,
+    HTTP_NO_RESPONSE
+};
+
+struct HttpCounters
+{
+    unsigned long requests;
+    unsigned long connectFailures;
+    unsigned long sendFailures;
+    unsigned long timeouts;
+    unsigned long badStatus;
+};
+
+// Next piece of the body: `part` counts from 0, nullptr after the last one. The text has to
+// stay valid until the following call.
+using HttpBodyCallback = const char* (*)(const void*, unsigned char part, unsigned char* length);
+using HttpCallback = void (*)(const void*, HttpResult result, unsigned short status);
+
+static const char HTTP_IPD[] PROGMEM = "+IPD,";
+
+// One HTTP POST at a time, split into steps so no update() blocks for a whole request:
+// connect, headers in one send, body in HTTP_CHUNK sends, status line, close.
+// The steps are raw AT exchanges on link 0 (WiFi.init() puts the ESP in AT+CIPMUX=1):
+// AT+CIPSTART, AT+CIPSEND with its "> " prompt and SEND OK, +IPD, AT+CIPCLOSE.
+// A command is written in one update() and its answer read in the following ones, so an
+// unreachable server costs HTTP_CONNECT_TIMEOUT of waiting, not of blocking. What still
+// blocks is writing to Serial1 once its 64 byte buffer is full, ~9 ms for the headers.
+// The serial port is shared with InfluxSender, which keeps off it while busy().
+// The body comes from the caller piece by piece, so it never has to exist as a whole.
+class HttpPost
+{
+private:
+    const char* _host;
+    unsigned short _port;
+    EspAt _at;
+    HttpState _state = HTTP_IDLE;
+    HttpResult _result = HTTP_DONE;
+    unsigned short _status = 0;
+    unsigned char _status_digits = 0;
+    bool _status_started = false;
+
+    const char* _path = nullptr;
+    unsigned short _length = 0;
+    const void* _body_context = nullptr;
+    HttpBodyCallback _body = nullptr;
+    unsigned char _part = 0;
+    const char* _part_text = nullptr;
+    unsigned char _part_length = 0;
+    unsigned char _part_sent = 0;
+    bool _prompted = false;       // the running AT+CIPSEND got its "> ", the data is out
+    unsigned char _ipd = 0;       // how far "+IPD,<link>,<length>:" of the response got
+    unsigned long _started = 0;
+
+    HttpCounters _counters = {0, 0, 0, 0, 0};
+    Observers<HttpCallback, HTTP_OBSERVERS> _callbacks;
+
+    void _connect();
+    AtReply _send(const char* data, unsigned char length);
+    void _sendHeaders();
+    void _sendBody();
+    void _readStatus();
+    void _close();
+    void _fail(HttpResult result);
+
+public:
+    HttpPost(const char* host, unsigned short port);
+    void Init(Stream* espSerial);
+    void addCallback(const void* context, HttpCallback callback);
+    bool post(const char* path, unsigned short length, const void* context, HttpBodyCallback body);
+    bool busy();
+    void update();
+    const HttpCounters& counters();
+    void printCounters(Print* out);
+
+    static void wrapperUpdate(const void* context);
+    static void wrapperCountersCommand(const void* context, Print* out, const char* args);
+};
+
+HttpPost::HttpPost(const char* host, unsigned short port) : _host(host), _port(port) {}
+
+inline void HttpPost::Init(Stream* espSerial)
+{
+    _at.Init(espSerial);
+    Serial.println(F("HTTP client initialized"));
+}
+
+inline void HttpPost::addCallback(const void* context, HttpCallback callback)
+{
+    _callbacks.add(context, callback);
+}
+
+// Starts a request of `length` body bytes, false while the previous one is still running.
+bool HttpPost::post(const char* path, unsigned short length, const void* context, HttpBodyCallback body)
+{
+    if (_state != HTTP_IDLE) return false;
+    _path = path;
+    _length = length;
+    _body_context = context;
+    _body = body;
+    _part = 0;
+    _part_text = nullptr;
+    _status = 0;
+    _status_digits = 0;
+    _status_started = false;
+    _ipd = 0;
+    _result = HTTP_DONE;
+    _counters.requests++;
+    _state = HTTP_CONNECT;
+    return true;
+}
+
+inline bool HttpPost::busy() { return _state != HTTP_IDLE; }
+
+void HttpPost::update()
+{
+    switch (_state)
+    {
+        case HTTP_IDLE:
+            break;
+        case HTTP_CONNECT:
+            _connect();
+            break;
+        case HTTP_HEADERS:
+            _sendHeaders();
+            break;
+        case HTTP_BODY:
+            _sendBody();
+            break;
+        case HTTP_STATUS:
+            _readStatus();
+            break;
+        case HTTP_CLOSE:
+            _close();
+            break;
+    }
+}
+
+void HttpPost::_connect()
+{
+    if (!_at.busy())
+    {
+        Stream* esp = _at.serial();
+        _at.start();
+        esp->print(F("AT+CIPSTART=0,\"TCP\",\""));
+        esp->print(_host);
+        esp->print(F("\","));
+        esp->print(_port);
+        esp->print(F("\r\n"));
+        return;
+    }
+    AtReply reply;
+    while ((reply = _at.poll(HTTP_CONNECT_TIMEOUT)) == AT_LINE) {} // 0,CONNECT
+    if (reply == AT_PENDING) return;
+    _at.done();
+    if (reply == AT_OK) _state = HTTP_HEADERS;
+    else _fail(HTTP_CONNECT_FAILED);
+}
+
+// One AT+CIPSEND exchange, AT_PENDING until SEND OK or the failure. `data` is written
+// once the prompt is there, it has to be the same on every call until then.
+AtReply HttpPost::_send(const char* data, unsigned char length)
+{
+    Stream* esp = _at.serial();
+    if (!_at.busy())
+    {
+        _prompted = false;
+        _at.start();
+        esp->print(F("AT+CIPSEND=0,"));
+        esp->print(length);
+        esp->print(F("\r\n"));
+        return AT_PENDING;
+    }
+    for (;;)
+    {
+        AtReply reply = _at.poll(HTTP_SEND_TIMEOUT);
+        if (reply == AT_LINE || (reply == AT_OK && !_prompted)) continue; // "OK" before the prompt, "Recv n bytes"
+        if (reply == AT_PROMPT)
+        {
+            if (!_prompted) esp->write((const uint8_t*)data, length);
+            _prompted = true;
+            _at.wait(); // for SEND OK
+            continue;
+        }
+        if (reply != AT_PENDING) _at.done();
+        return reply;
+    }
+}
+
+// rebuilt on every call rather than kept for the whole exchange, they are the same each time
+void HttpPost::_sendHeaders()
+{
+    TextBuffer<HTTP_HEADER_LENGTH> headers;
+    headers.textP(PSTR("POST ")).text(_path).textP(PSTR(" HTTP/1.1\r\nHost: ")).text(_host).put(':').number(_port);
+    headers.textP(PSTR("\r\nContent-Type: text/plain; charset=utf-8\r\nConnection: close\r\nContent-Length: "));
+    headers.number(_length).textP(PSTR("\r\n\r\n"));
+    AtReply reply = _send(headers.c_str(), headers.length());
+    if (reply == AT_OK) _state = HTTP_BODY;
+    else if (reply != AT_PENDING) _fail(HTTP_SEND_FAILED);
+}
+
+// one chunk per call, the next part is fetched once the current one is out
+void HttpPost::_sendBody()
+{
+    if (!_part_text)
+    {
+        _part_text = _body(_body_context, _part, &_part_length);
+        _part_sent = 0;
+        if (!_part_text)
+        {
+            _started = millis();
+            _state = HTTP_STATUS;
+            return;
+        }
+    }
+    unsigned char chunk = _part_length - _part_sent;
+    if (chunk > HTTP_CHUNK) chunk = HTTP_CHUNK;
+    if (chunk)
+    {
+        AtReply reply = _send(_part_text + _part_sent, chunk);
+        if (reply == AT_PENDING) return;
+        if (reply != AT_OK)
+        {
+            _fail(HTTP_SEND_FAILED);
+            return;
+        }
+    }
+    _part_sent += chunk;
+    if (_part_sent >= _part_length)
+    {
+        _part_text = nullptr;
+        _part++;
+    }
+}
+
+// "+IPD,0,<length>[,<ip>,<port>]:HTTP/1.1 204 No Content": the number after the first space
+// of the data, the rest is not needed. Read straight from the port, the line is too long for EspAt.
+void HttpPost::_readStatus()
+{
+    Stream* esp = _at.serial();
+    for (unsigned char i = 0; i < HTTP_READ_PER_STEP && esp->available(); i++)
+    {
+        char c = esp->read();
+        if (_ipd < 5)
+        {
+            if (c == pgm_read_byte(&HTTP_IPD[_ipd])) _ipd++;
+            else _ipd = (c == '+');
+        }
+        else if (_ipd == 5)
+        {
+            if (c == ':') _ipd++;
+        }
+        else if (!_status_started)
+        {
+            _status_started = (c == ' ');
+        }
+        else if (c >= '0' && c <= '9' && _status_digits < 3)
+        {
+            _status = _status * 10 + (c - '0');
+            _status_digits++;
+        }
+        else
+        {
+            _state = HTTP_CLOSE;
+            return;
+        }
+    }
+    if (millis() - _started >= HTTP_RESPONSE_TIMEOUT) _fail(HTTP_NO_RESPONSE);
+}
+
+// AT+CIPCLOSE, whatever it answers; the server may have closed the link already
+void HttpPost::_close()
+{
+    if (!_at.busy())
+    {
+        _at.start();
+        _at.serial()->print(F("AT+CIPCLOSE=0\r\n"));
+        return;
+    }
+    AtReply reply;
+    while ((reply = _at.poll(HTTP_CLOSE_TIMEOUT)) == AT_LINE) {} // 0,CLOSED
+    if (reply == AT_PENDING) return;
+    _at.done();
+    _state = HTTP_IDLE;
+    if (_result == HTTP_DONE && (_status < 200 || _status > 299)) _counters.badStatus++;
+    _callbacks.notify(_result, _status);
+}
+
+void HttpPost::_fail(HttpResult result)
+{
+    switch (result)
+    {
+        case HTTP_CONNECT_FAILED: _counters.connectFailures++; break;
+        case HTTP_SEND_FAILED: _counters.sendFailures++; break;
+        case HTTP_NO_RESPONSE: _counters.timeouts++; break;
+        default: break;
+    }
+    _at.done();
+    _result = result;
+    _state = HTTP_CLOSE;
+}
+
+inline const HttpCounters& HttpPost::counters() { return _counters; }
+
+void HttpPost::printCounters(Print* out)
+{
+    out->print(F("requests="));
+    out->print(_counters.requests);
+    out->print(F(" connect_fail="));
+    out->print(_counters.connectFailures);
+    out->print(F(" send_fail="));
+    out->print(_counters.sendFailures);
+    out->print(F(" timeouts="));
+    out->print(_counters.timeouts);
+    out->print(F(" bad_status="));
+    out->print(_counters.badStatus);
+    out->print(F(" last="));
+    out->println(_status);
+}
+
+void HttpPost::wrapperUpdate(const void* context)
+{
+    HttpPost* obj = (HttpPost*)context;
+    obj->update();
+}
+
+void HttpPost::wrapperCountersCommand(const void* context, Print* out, const char* args)
+{
+    HttpPost* obj = (HttpPost*)context;
+    if (strcmp_P(args, PSTR("reset")) == 0) obj->_counters = {0, 0, 0, 0, 0};
+    obj->printCounters(out);
+}
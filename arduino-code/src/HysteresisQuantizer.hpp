@@ -0,0 +1,91 @@
+#pragma once
+
+// Maps a reading onto N+1 levels separated by N sorted thresholds, with a hysteresis band
+// around every threshold. Level k means thresholds[k-1] <= value < thresholds[k].
+// Classification is two binary searches and a clamp, the same cost for every level:
+//   lo = thresholds clearly passed (value >= t + band) -> the level can not be lower
+//   hi = thresholds not clearly below (value >= t - band) -> the level can not be higher
+// A level between lo and hi is kept, so a value inside a band never changes it.
+template <unsigned char N>
+class HysteresisQuantizer
+{
+private:
+    const short* _thresholds;
+    short _band;
+    unsigned char _level = 0;
+    bool _valid = false;
+
+    static unsigned char _count(const short* thresholds, short value);
+
+public:
+    HysteresisQuantizer(const short* thresholds, short band);
+
+    static unsigned char classify(const short* thresholds, short value);
+    static unsigned char step(const short* thresholds, short band, unsigned char level, short value);
+
+    unsigned char update(short value);
+    unsigned char level();
+    bool valid();
+    void band(short band);
+    void thresholds(const short* thresholds);
+    void reset();
+};
+
+template <unsigned char N>
+HysteresisQuantizer<N>::HysteresisQuantizer(const short* thresholds, short band) : _thresholds(thresholds), _band(band) {}
+
+// number of thresholds <= value
+template <unsigned char N>
+unsigned char HysteresisQuantizer<N>::_count(const short* thresholds, short value)
+{
+    unsigned char lo = 0;
+    unsigned char hi = N;
+    while (lo < hi)
+    {
+        unsigned char mid = (lo + hi) / 2;
+        if (thresholds[mid] <= value) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Level without history, used for the first reading.
+template <unsigned char N>
+inline unsigned char HysteresisQuantizer<N>::classify(const short* thresholds, short value)
+{
+    return _count(thresholds, value);
+}
+
+// Stateless form for callers that keep the level themselves (e.g. packed in a bit field).
+template <unsigned char N>
+unsigned char HysteresisQuantizer<N>::step(const short* thresholds, short band, unsigned char level, short value)
+{
+    unsigned char lo = _count(thresholds, value - band);
+    unsigned char hi = _count(thresholds, value + band);
+    if (level < lo) return lo;
+    if (level > hi) return hi;
+    return level;
+}
+
+template <unsigned char N>
+unsigned char HysteresisQuantizer<N>::update(short value)
+{
+    _level = _valid ? step(_thresholds, _band, _level, value) : classify(_thresholds, value);
+    _valid = true;
+    return _level;
+}
+
+template <unsigned char N>
+inline unsigned char HysteresisQuantizer<N>::level() { return _level; }
+
+template <unsigned char N>
+inline bool HysteresisQuantizer<N>::valid() { return _valid; }
+
+template <unsigned char N>
+inline void HysteresisQuantizer<N>::band(short band) { _band = band; }
+
+template <unsigned char N>
+inline void HysteresisQuantizer<N>::thresholds(const short* thresholds) { _thresholds = thresholds; }
+
+template <unsigned char N>
+inline void HysteresisQuantizer<N>::reset() { _valid = false; }
@@ -7,6 +7,11 @@
 #include "Light.hpp"
 #include "WaterLevelSensor.hpp"
 #include "SoilSensor.hpp"
+#include "HttpPost.hpp"
+#include "EspAt.hpp"
+#include "TelemetryQueue.hpp"
+#include "TextBuffer.hpp"
+#include "virtuabotixRTC.h"
 
 // Definicje stałych nazw pól w InfluxDB
 #define DATA_TEMP_IN "temp_in"
@@ -19,29 +24,90 @@
 #define DATA_SOIL_HUM_2 "soil_hum_2"
 #define DATA_SOIL_HUM_3 "soil_hum_3"
 
+#define INFLUX_PATH_LENGTH 48   // "/write?db=<db>&precision=s" + '\0'
+#define INFLUX_LINE_LENGTH 224  // one point in line protocol with its timestamp, every field at its longest
+
+// Paczki pomiarów
+#define INFLUX_BATCH_POINTS 10     // points per POST at most
+#define INFLUX_BATCH_AGE 600       //s, the oldest point waits at most this long for the rest
+#define INFLUX_RETRY_DELAY 60000   //ms after a failed POST
+#define INFLUX_POST_INTERVAL 10000 //ms between POSTs at least, paces the backlog after an outage
+#define INFLUX_RTC_SYNC 3600000UL  //ms between RTC reads, millis() counts in between
+#define INFLUX_RTC_UTC_OFFSET 0    //s, RTC time minus UTC (3600 if the RTC keeps CET)
+
+// Połączenie WiFi
+#define WIFI_WAIT_TIME 10000     //ms, the ESP may still finish a join begin() gave up on
+#define WIFI_BACKOFF_MIN 5000    //ms, first retry after a failed probe or join
+#define WIFI_BACKOFF_MAX 600000  //ms, doubled after every failure up to this
+#define WIFI_POLL_PERIOD 5000    //ms, link checks while backing off, the ESP rejoins a known AP itself
+#define WIFI_AT_TIMEOUT 2000     //ms for the module to answer "AT" or AT+CIPSTATUS, silent means gone
+#define WIFI_JOIN_TIMEOUT 20000  //ms for AT+CWJAP_CUR to end in OK or FAIL
+
+// The probe, the join and the link checks are raw AT exchanges: the command is written in one
+// Update() and the answer read in the following ones, so none of them blocks the loop. The only
+// library call left is WiFi.init() when the probe finds the module (AT+RST and setup, ~3.5 s),
+// at boot and again after the module stopped answering and came back.
+enum WifiState : unsigned char
+{
+    WIFI_PROBE,     // "AT", is the ESP module there
+    WIFI_JOIN,      // AT+CWJAP_CUR
+    WIFI_WAIT,      // polling AT+CIPSTATUS after a failed join or a dropped link
+    WIFI_BACKOFF,   // waiting _backoff ms before the next probe or join, polling AT+CIPSTATUS
+    WIFI_CONNECTED
+};
+
+struct WifiCounters
+{
+    unsigned short probes;
+    unsigned short joins;
+    unsigned short failures;
+    unsigned short drops;
+    unsigned short reconnects;
+};
+
 class InfluxSender {
 private:
     // Konfiguracja sieci i serwera
     const char* _ssid;
     const char* _pass;
-    const char* _host;
-    int _port;
     const char* _dbName;
     const char* _measurement;
     const char* _version;
     
     // Timer
-    unsigned long _lastSendTime;
+    unsigned long _lastSampleTime;
     unsigned long _logPeriod;
 
-    // Klient WiFi
-    WiFiEspClient _client;
+    // Kolejka pomiarów i zegar
+    TelemetryQueue* _queue;
+    unsigned char _sending;   // oldest points of the queue in the POST under way
+    bool _post_failed;
+    unsigned long _last_post;
+    virtuabotixRTC* _rtc;
+    unsigned long _clock_epoch; // 0 until the RTC gave a valid time
+    unsigned long _clock_read;
+
+    // Klient WiFi i HTTP
+    HttpPost* _http;
+    TextBuffer<INFLUX_PATH_LENGTH> _path;
+    TextBuffer<INFLUX_LINE_LENGTH> _line; // point being sent, fixed until HttpPost asks for the next
+    Stream* _wifi_serial;
+    EspAt _at;                // command of the current state, busy() until its answer is handled
+    bool _at_link;            // AT+CIPSTATUS answered with a joined station
+    WifiState _wifi_state;
+    unsigned long _wifi_since;
+    unsigned long _last_poll;
+    unsigned long _backoff;
+    bool _module_found;
+    bool _was_connected;
+    bool _check_link;
+    WifiCounters _wifi_counters;
 
     // Dane do wysłania
-    float _tempIn;
-    float _tempOut;
-    float _humIn;
-    float _humOut;
+    Centi _tempIn;
+    Centi _tempOut;
+    Centi _humIn;
+    Centi _humOut;
     int _soilHum1;
     int _soilHum2;
     int _soilHum3;
@@ -56,30 +122,53 @@ private:
     Light* _light;
 
     // Metody callbacków
-    void _onDHTInChanged(const float* temp, const float* hum);
-    void _onDHTOutChanged(const float* temp, const float* hum);
+    void _onDHTInChanged(const Centi* temp, const Centi* hum);
+    void _onDHTOutChanged(const Centi* temp, const Centi* hum);
     void _onLightChanged(const unsigned char* level);
     void _onWaterChanged(const unsigned char* level);
     void _onSoilChanged(const unsigned char* id, const SoilSensorState* state);
 
+    void _onPosted(HttpResult result, unsigned short status);
+    const char* _body(unsigned char part, unsigned char* length);
+
     // Wrapper callbacki
-    static void _wrapperDHTInChanged(const void* context, const float* temp, const float* hum);
-    static void _wrapperDHTOutChanged(const void* context, const float* temp, const float* hum);
+    static void _wrapperPosted(const void* context, HttpResult result, unsigned short status);
+    static const char* _wrapperBody(const void* context, unsigned char part, unsigned char* length);
+    static void _wrapperDHTInChanged(const void* context, const Centi* temp, const Centi* hum);
+    static void _wrapperDHTOutChanged(const void* context, const Centi* temp, const Centi* hum);
     static void _wrapperLightChanged(const void* context, const unsigned char* level);
     static void _wrapperWaterChanged(const void* context, const unsigned char* level);
     static void _wrapperSoilChanged(const void* context, const unsigned char* id, const SoilSensorState* state);
 
-    // Deklaracja metody prywatnej
+    // Deklaracja metod prywatnych
     void sendDataToDB();
+    void _sample();
+    bool _flushDue();
+    void _formatPoint(const TelemetryPoint& point, TextBuffer<INFLUX_LINE_LENGTH>& line);
+    void _syncClock();
+    unsigned long _clockTime();
+    static unsigned long _epoch(int year, unsigned char month, unsigned char day, unsigned char hour, unsigned char minute, unsigned char second);
+    void _updateWifi();
+    AtReply _linkStatus();
+    void _moduleLost();
+    void _enterWifi(WifiState state);
+    void _wifiConnected();
+    void _wifiRetryLater();
 
 public:
     // Deklaracja Konstruktora
-    InfluxSender(const char* ssid, const char* pass, const char* host, int port, const char* db, const char* measurement, unsigned long logPeriodMs, const char* version);
+    InfluxSender(const char* ssid, const char* pass, const char* db, const char* measurement, unsigned long logPeriodMs, const char* version);
 
     // Deklaracje metod publicznych
-    void Init(Stream* wifiSerial, DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, 
+    void Init(Stream* wifiSerial, HttpPost* http, TelemetryQueue* queue, virtuabotixRTC* rtc, DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, 
              SoilSensor* soil2, SoilSensor* soil3, WaterLevelSensor* water, Light* light);
     void Update();
+    WifiState wifiState();
+    const WifiCounters& wifiCounters();
+    void printStatus(Print* out);
+
+    static void wrapperUpdate(const void* context);
+    static void wrapperStatusCommand(const void* context, Print* out, const char* args);
 };
 
 // ================================================================
@@ -87,19 +176,17 @@ public:
 // ================================================================
 
 // Konstruktor
-InfluxSender::InfluxSender(const char* ssid, const char* pass, const char* host, int port, const char* db, const char* measurement, unsigned long logPeriodMs, const char* version){
+InfluxSender::InfluxSender(const char* ssid, const char* pass, const char* db, const char* measurement, unsigned long logPeriodMs, const char* version){
     _ssid = ssid;
     _pass = pass;
-    _host = host;
-    _port = port;
     _dbName = db;
     _measurement = measurement;
     _logPeriod = logPeriodMs;
-    _lastSendTime = 0;
+    _lastSampleTime = 0;
     _version = version;
     
     // Zerowanie zmiennych
-    _tempIn = 0.0; _tempOut = 0.0; _humIn = 0.0; _humOut = 0.0;
+    _tempIn = 0; _tempOut = 0; _humIn = 0; _humOut = 0;
     _soilHum1 = 0; _soilHum2 = 0; _soilHum3 = 0;
     _waterLevel = 0; _lightLevel = 0;
 
@@ -111,10 +198,30 @@ InfluxSender::InfluxSender(const char* ssid, const char* pass, const char* host,
     _soil[2] = nullptr;
     _water = nullptr;
     _light = nullptr;
+
+    _queue = nullptr;
+    _sending = 0;
+    _post_failed = false;
+    _last_post = 0;
+    _rtc = nullptr;
+    _clock_epoch = 0;
+    _clock_read = 0;
+
+    _http = nullptr;
+    _wifi_serial = nullptr;
+    _at_link = false;
+    _wifi_state = WIFI_PROBE;
+    _wifi_since = 0;
+    _last_poll = 0;
+    _backoff = WIFI_BACKOFF_MIN;
+    _module_found = false;
+    _was_connected = false;
+    _check_link = false;
+    _wifi_counters = {0, 0, 0, 0, 0};
 }
 
 // Inicjalizacja
-void InfluxSender::Init(Stream* wifiSerial, DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, 
+void InfluxSender::Init(Stream* wifiSerial, HttpPost* http, TelemetryQueue* queue, virtuabotixRTC* rtc, DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, 
                          SoilSensor* soil2, SoilSensor* soil3, WaterLevelSensor* water, Light* light) {
     // Przechowywanie wskaźników na sensory
     _dht_in = dhtIn;
@@ -124,6 +231,8 @@ void InfluxSender::Init(Stream* wifiSerial, DHTSensor* dhtIn, DHTSensor* dhtOut,
     _soil[2] = soil3;
     _water = water;
     _light = light;
+    _queue = queue;
+    _rtc = rtc;
 
     // Rejestracja callbacków
     _dht_in->addCallback(this, _wrapperDHTInChanged);
@@ -134,97 +243,345 @@ void InfluxSender::Init(Stream* wifiSerial, DHTSensor* dhtIn, DHTSensor* dhtOut,
     _water->addCallback(this, _wrapperWaterChanged);
     _light->addCallback(this, _wrapperLightChanged);
 
-    // Inicjalizacja modułu WiFiEsp na wskazanym porcie Serial
-    WiFi.init(wifiSerial);
+    // Wysyłanie przez HttpPost, zapytanie jest stałe
+    _http = http;
+    _http->addCallback(this, _wrapperPosted);
+    _path.textP(PSTR("/write?db=")).text(_dbName).textP(PSTR("&precision=s"));
+
+    // Moduł WiFiEsp na wskazanym porcie Serial, łączenie odbywa się w Update()
+    _wifi_serial = wifiSerial;
+    _at.Init(wifiSerial);
+    _enterWifi(WIFI_PROBE);
+    Serial.println(F("InfluxSender initialized"));
+}
+
+// Update (główna pętla): a sample when due, then one step of the connection or of the batch upload
+void InfluxSender::Update() {
+    if (millis() - _lastSampleTime > _logPeriod) {
+        _lastSampleTime = millis();
+        _sample();
+    }
+    if (_wifi_state != WIFI_CONNECTED) {
+        _updateWifi();
+        return;
+    }
+    if (_check_link) {
+        // the last send failed, server down or WiFi gone; the serial port is HttpPost's while it is busy
+        if (_http->busy()) return;
+        AtReply reply = _linkStatus();
+        if (reply == AT_PENDING) return;
+        _check_link = false;
+        _at.done();
+        if (reply == AT_OK && _at_link) return;
+        _wifi_counters.drops++;
+        if (reply == AT_TIMEOUT) {
+            _moduleLost();
+            return;
+        }
+        Serial.println(F("[InfluxSender] Utracono polaczenie WiFi"));
+        _enterWifi(WIFI_WAIT);
+        return;
+    }
+    if (!_http->busy() && _flushDue()) sendDataToDB();
+}
 
-    // Sprawdzenie obecności modułu
-    if (WiFi.status() == WL_NO_SHIELD) {
-        Serial.println(F("[InfluxSender] BLAD: Modul WiFi nie wykryty!"));
-        while (true); // Stop
+void InfluxSender::_updateWifi() {
+    switch (_wifi_state) {
+        case WIFI_PROBE: {
+            if (!_at.busy()) {
+                _wifi_counters.probes++;
+                _at.start();
+                _wifi_serial->print(F("AT\r\n"));
+                break;
+            }
+            AtReply reply;
+            while ((reply = _at.poll(WIFI_AT_TIMEOUT)) == AT_LINE) {} // the echo
+            if (reply == AT_OK) {
+                _module_found = true;
+                WiFi.init(_wifi_serial); // the library's setup, at boot or after a power loss of the ESP
+                _backoff = WIFI_BACKOFF_MIN; // from here on the retries are about the access point
+                _enterWifi(WIFI_JOIN);
+            } else if (reply != AT_PENDING) {
+                Serial.println(F("[InfluxSender] BLAD: Modul WiFi nie wykryty!"));
+                _wifiRetryLater();
+            }
+            break;
+        }
+        case WIFI_JOIN: {
+            if (!_at.busy()) {
+                Serial.print(F("[InfluxSender] Laczenie z WiFi: "));
+                Serial.println(_ssid);
+                _wifi_counters.joins++;
+                _at.start();
+                _wifi_serial->print(F("AT+CWJAP_CUR=\""));
+                _wifi_serial->print(_ssid);
+                _wifi_serial->print(F("\",\""));
+                _wifi_serial->print(_pass);
+                _wifi_serial->print(F("\"\r\n"));
+                break;
+            }
+            AtReply reply;
+            while ((reply = _at.poll(WIFI_JOIN_TIMEOUT)) == AT_LINE) {} // echo, WIFI CONNECTED, WIFI GOT IP
+            if (reply == AT_OK) _wifiConnected();
+            else if (reply != AT_PENDING) _enterWifi(WIFI_WAIT);
+            break;
+        }
+        case WIFI_WAIT: {
+            // one AT+CIPSTATUS after the other until the link is up or WIFI_WAIT_TIME is over
+            AtReply reply = _linkStatus();
+            if (reply == AT_PENDING) break;
+            _at.done();
+            if (reply == AT_TIMEOUT) _moduleLost();
+            else if (reply == AT_OK && _at_link) _wifiConnected();
+            else if (millis() - _wifi_since >= WIFI_WAIT_TIME) {
+                _wifi_counters.failures++;
+                _wifiRetryLater();
+            }
+            break;
+        }
+        case WIFI_BACKOFF:
+            if (_at.busy()) {
+                AtReply reply = _linkStatus();
+                if (reply == AT_PENDING) break;
+                _at.done();
+                if (reply == AT_TIMEOUT) {
+                    _moduleLost();
+                    break;
+                }
+                if (reply == AT_OK && _at_link) {
+                    _wifiConnected();
+                    break;
+                }
+            }
+            if (millis() - _wifi_since >= _backoff) {
+                _backoff = (_backoff < WIFI_BACKOFF_MAX / 2) ? 2 * _backoff : WIFI_BACKOFF_MAX;
+                _enterWifi(_module_found ? WIFI_JOIN : WIFI_PROBE);
+            } else if (_module_found && millis() - _last_poll >= WIFI_POLL_PERIOD) {
+                _last_poll = millis();
+                _linkStatus(); // writes the command, the answer is read from the next Update() on
+            }
+            break;
+        case WIFI_CONNECTED:
+            break;
     }
+}
+
+inline void InfluxSender::_enterWifi(WifiState state) {
+    _wifi_state = state;
+    _wifi_since = millis();
+    _at.done();
+}
 
-    // Łączenie z WiFi
-    while (WiFi.status() != WL_CONNECTED) {
-        Serial.print(F("[InfluxSender] Laczenie z WiFi: "));
-        Serial.println(_ssid);
-        WiFi.begin(_ssid, _pass);
+// AT+CIPSTATUS, written on the first call, then its answer polled: AT_OK with _at_link set
+// when the ESP has joined, AT_TIMEOUT when it does not answer at all
+AtReply InfluxSender::_linkStatus() {
+    if (!_at.busy()) {
+        _at.start();
+        _at_link = false;
+        _wifi_serial->print(F("AT+CIPSTATUS\r\n"));
+        return AT_PENDING;
     }
+    AtReply reply;
+    while ((reply = _at.poll(WIFI_AT_TIMEOUT)) == AT_LINE) {
+        // STATUS:2 got IP, 3 connections open, 4 connections closed; 5 not joined
+        const char* line = _at.line();
+        if (!strncmp_P(line, PSTR("STATUS:"), 7)) _at_link = line[7] >= '2' && line[7] <= '4';
+    }
+    return reply;
+}
+
+// The ESP stopped answering (brown-out, unplugged): find it again before the next join
+void InfluxSender::_moduleLost() {
+    Serial.println(F("[InfluxSender] BLAD: Modul WiFi nie odpowiada!"));
+    _module_found = false;
+    _backoff = WIFI_BACKOFF_MIN;
+    _enterWifi(WIFI_PROBE);
+}
 
+void InfluxSender::_wifiConnected() {
+    if (_was_connected) _wifi_counters.reconnects++;
+    _was_connected = true;
+    _backoff = WIFI_BACKOFF_MIN;
+    _enterWifi(WIFI_CONNECTED);
     Serial.println(F("[InfluxSender] Polaczono z WiFi!"));
     Serial.print(F("IP: "));
     Serial.println(WiFi.localIP());
-    Serial.println("InfluxSender initialized");
 }
 
-// Update (główna pętla)
-void InfluxSender::Update() {
-    if (millis() - _lastSendTime > _logPeriod) {
-        _lastSendTime = millis();
-        sendDataToDB();
-    }
+void InfluxSender::_wifiRetryLater() {
+    _enterWifi(WIFI_BACKOFF);
+    Serial.print(F("[InfluxSender] Ponowna proba za "));
+    Serial.print(_backoff / 1000);
+    Serial.println(F(" s"));
+}
+
+inline WifiState InfluxSender::wifiState() { return _wifi_state; }
+
+inline const WifiCounters& InfluxSender::wifiCounters() { return _wifi_counters; }
+
+void InfluxSender::printStatus(Print* out) {
+    static const char WIFI_STATE_STR[5][10] PROGMEM = {"PROBE", "JOIN", "WAIT", "BACKOFF", "CONNECTED"};
+    out->print(F("state="));
+    out->print((const __FlashStringHelper*)WIFI_STATE_STR[_wifi_state]);
+    out->print(F(" for="));
+    out->print((millis() - _wifi_since) / 1000);
+    out->print(F("s backoff="));
+    out->print(_backoff / 1000);
+    out->print(F("s probes="));
+    out->print(_wifi_counters.probes);
+    out->print(F(" joins="));
+    out->print(_wifi_counters.joins);
+    out->print(F(" failures="));
+    out->print(_wifi_counters.failures);
+    out->print(F(" drops="));
+    out->print(_wifi_counters.drops);
+    out->print(F(" reconnects="));
+    out->print(_wifi_counters.reconnects);
+    out->print(F(" time="));
+    out->println(_clockTime());
 }
 
-// Metoda prywatna wysyłająca dane
+// Metoda prywatna wysyłająca dane: najstarsze punkty z kolejki jednym POST, HttpPost pobiera
+// linie po kolei. Content-Length needs every line once up front, _line is free until the POST starts.
 void InfluxSender::sendDataToDB() {
-    Serial.println(F("[InfluxSender] Rozpoczynam wysylanie danych..."));
-
-    if (_client.connect(_host, _port)) {
-        Serial.println(F("[InfluxSender] Polaczono z serwerem!"));
-
-        // 1. Budowanie Payload (Line Protocol)
-        String payload = "";
-        payload += _measurement;
-        payload += ",version=";
-        payload += _version;
-        payload += " ";
-        
-        payload += DATA_TEMP_IN; payload += "="; payload += String(_tempIn, 2); payload += ",";
-        payload += DATA_TEMP_OUT; payload += "="; payload += String(_tempOut, 2); payload += ",";
-        payload += DATA_HUM_IN; payload += "="; payload += String(_humIn, 2); payload += ",";
-        payload += DATA_HUM_OUT; payload += "="; payload += String(_humOut, 2); payload += ",";
-        payload += DATA_WATER_L; payload += "="; payload += String(_waterLevel); payload += ",";
-        payload += DATA_LIGHT_L; payload += "="; payload += String(_lightLevel); payload += ",";
-        payload += DATA_SOIL_HUM_1; payload += "="; payload += String(_soilHum1); payload += ",";
-        payload += DATA_SOIL_HUM_2; payload += "="; payload += String(_soilHum2); payload += ",";
-        payload += DATA_SOIL_HUM_3; payload += "="; payload += String(_soilHum3);
-
-        // 2. Wysyłanie nagłówków HTTP
-        _client.print("POST /write?db=");
-        _client.print(_dbName);
-        _client.println("&precision=s HTTP/1.1");
-        
-        _client.print("Host: ");
-        _client.print(_host);
-        _client.print(":");
-        _client.println(_port);
-        
-        _client.println("Content-Type: text/plain; charset=utf-8");
-        //_client.println("Connection: close"); 
-        
-        _client.print("Content-Length: ");
-        _client.println(payload.length());
-        _client.println(); // Pusta linia
-        
-        // 3. Wysyłanie danych
-        _client.print(payload);
-        
-        Serial.println(F("[InfluxSender] Dane wyslane. Zamykam polaczenie."));
-        _client.stop();
-    } else {
-        Serial.println(F("[InfluxSender] BLAD: Nie udalo sie polaczyc z serwerem InfluxDB"));
+    unsigned short count = _queue->count();
+    if (count > INFLUX_BATCH_POINTS) count = INFLUX_BATCH_POINTS;
+    unsigned short length = 0;
+    TelemetryPoint point;
+    for (unsigned char i = 0; i < count; i++) {
+        _queue->read(i, &point);
+        // the server stamps an unstamped point with the arrival time, one time for the whole POST
+        if (!point.time && i) {
+            count = i;
+            break;
+        }
+        _formatPoint(point, _line);
+        length += _line.length();
+        if (!point.time) count = 1;
+    }
+    Serial.print(F("[InfluxSender] Wysylanie pomiarow: "));
+    Serial.println(count);
+    _sending = count;
+    _queue->hold(count);
+    _last_post = millis();
+    _http->post(_path.c_str(), length, this, _wrapperBody);
+}
+
+// Current readings into the queue, marked as delayed when they cannot go out on time.
+void InfluxSender::_sample() {
+    if (!_clock_epoch || millis() - _clock_read >= INFLUX_RTC_SYNC) _syncClock();
+    TelemetryPoint point;
+    point.time = _clockTime();
+    point.tempIn = _tempIn;
+    point.tempOut = _tempOut;
+    point.humIn = _humIn;
+    point.humOut = _humOut;
+    point.soil[0] = _soilHum1;
+    point.soil[1] = _soilHum2;
+    point.soil[2] = _soilHum3;
+    point.water = _waterLevel;
+    point.light = _lightLevel;
+    _queue->push(point, _wifi_state != WIFI_CONNECTED || _post_failed);
+}
+
+// A full batch, an old enough oldest point, or a point without timestamp (never held back,
+// the server stamps it on arrival, so sendDataToDB() posts it on its own). POSTs are INFLUX_POST_INTERVAL apart at least, so a backlog
+// drains in steps; after a failure the next try waits INFLUX_RETRY_DELAY.
+bool InfluxSender::_flushDue() {
+    unsigned short count = _queue->count();
+    if (!count) return false;
+    if (millis() - _last_post < (_post_failed ? INFLUX_RETRY_DELAY : INFLUX_POST_INTERVAL)) return false;
+    TelemetryPoint oldest;
+    _queue->read(0, &oldest);
+    if (count >= INFLUX_BATCH_POINTS || !oldest.time || !_queue->newestStamped()) return true;
+    return _clockTime() - oldest.time >= INFLUX_BATCH_AGE;
+}
+
+// Line Protocol: measurement,version=x temp_in=..,...,soil_hum_3=.. <epoch s>
+void InfluxSender::_formatPoint(const TelemetryPoint& point, TextBuffer<INFLUX_LINE_LENGTH>& line) {
+    line.clear();
+    line.text(_measurement).textP(PSTR(",version=")).text(_version).put(' ');
+    line.textP(PSTR(DATA_TEMP_IN "=")).centi(point.tempIn, 2);
+    line.textP(PSTR("," DATA_TEMP_OUT "=")).centi(point.tempOut, 2);
+    line.textP(PSTR("," DATA_HUM_IN "=")).centi(point.humIn, 2);
+    line.textP(PSTR("," DATA_HUM_OUT "=")).centi(point.humOut, 2);
+    line.textP(PSTR("," DATA_WATER_L "=")).number(point.water);
+    line.textP(PSTR("," DATA_LIGHT_L "=")).number(point.light);
+    line.textP(PSTR("," DATA_SOIL_HUM_1 "=")).number(point.soil[0]);
+    line.textP(PSTR("," DATA_SOIL_HUM_2 "=")).number(point.soil[1]);
+    line.textP(PSTR("," DATA_SOIL_HUM_3 "=")).number(point.soil[2]);
+    if (point.time) line.put(' ').number(point.time);
+    line.put('\n');
+}
+
+// Reading the DS1302 bit-bangs 9 bytes, so it is only read every INFLUX_RTC_SYNC.
+void InfluxSender::_syncClock() {
+    _rtc->updateTime();
+    _clock_read = millis();
+    bool valid = _rtc->year >= 2020 && _rtc->month >= 1 && _rtc->month <= 12 && _rtc->dayofmonth >= 1
+        && _rtc->dayofmonth <= 31 && _rtc->hours < 24 && _rtc->minutes < 60 && _rtc->seconds < 60;
+    if (!valid) {
+        _clock_epoch = 0;
+        return;
     }
+    _clock_epoch = _epoch(_rtc->year, _rtc->month, _rtc->dayofmonth, _rtc->hours, _rtc->minutes, _rtc->seconds)
+        - INFLUX_RTC_UTC_OFFSET;
+}
+
+// s since 1970 UTC, 0 without a valid RTC time
+inline unsigned long InfluxSender::_clockTime() {
+    if (!_clock_epoch) return 0;
+    return _clock_epoch + (millis() - _clock_read) / 1000;
+}
+
+// Calendar time to s since 1970, valid for 1970..2099 (every 4th year a leap year).
+unsigned long InfluxSender::_epoch(int year, unsigned char month, unsigned char day, unsigned char hour, unsigned char minute, unsigned char second) {
+    static const unsigned short DAYS_BEFORE_MONTH[12] PROGMEM = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    unsigned long days = (year - 1970) * 365UL + (year - 1969) / 4 + pgm_read_word(&DAYS_BEFORE_MONTH[month - 1]) + day - 1;
+    if (month > 2 && year % 4 == 0) days++;
+    return ((days * 24 + hour) * 60 + minute) * 60 + second;
 }
 
 // ================================================================
 // IMPLEMENTACJA CALLBACKÓW
 // ================================================================
 
-inline void InfluxSender::_onDHTInChanged(const float* temp, const float* hum) {
+// Sent points leave the queue, after a failure they stay for the next try.
+void InfluxSender::_onPosted(HttpResult result, unsigned short status) {
+    unsigned char sent = _sending;
+    _sending = 0;
+    _post_failed = !(result == HTTP_DONE && status >= 200 && status <= 299);
+    if (!_post_failed) {
+        _queue->remove(sent);
+        Serial.println(F("[InfluxSender] Dane wyslane."));
+        return;
+    }
+    _queue->hold(0);
+    _queue->markDelayed();
+    if (result == HTTP_DONE) {
+        Serial.print(F("[InfluxSender] BLAD: Serwer odpowiedzial "));
+        Serial.println(status);
+        return;
+    }
+    Serial.println(F("[InfluxSender] BLAD: Nie udalo sie wyslac danych do InfluxDB"));
+    _check_link = true; // serwer albo WiFi, sprawdzane w następnym Update()
+}
+
+// część = jeden punkt z wysyłanej paczki
+inline const char* InfluxSender::_body(unsigned char part, unsigned char* length) {
+    TelemetryPoint point;
+    if (part >= _sending || !_queue->read(part, &point)) return nullptr;
+    _formatPoint(point, _line);
+    *length = _line.length();
+    return _line.c_str();
+}
+
+inline void InfluxSender::_onDHTInChanged(const Centi* temp, const Centi* hum) {
     if(temp) _tempIn = *temp;
     if(hum) _humIn = *hum;
 }
 
-inline void InfluxSender::_onDHTOutChanged(const float* temp, const float* hum) {
+inline void InfluxSender::_onDHTOutChanged(const Centi* temp, const Centi* hum) {
     if(temp) _tempOut = *temp;
     if(hum) _humOut = *hum;
 }
@@ -257,12 +614,22 @@ inline void InfluxSender::_onSoilChanged(const unsigned char* id, const SoilSens
 // WRAPPER CALLBACKI
 // ================================================================
 
-void InfluxSender::_wrapperDHTInChanged(const void* context, const float* temp, const float* hum) {
+void InfluxSender::_wrapperPosted(const void* context, HttpResult result, unsigned short status) {
+    InfluxSender* obj = (InfluxSender*)context;
+    obj->_onPosted(result, status);
+}
+
+const char* InfluxSender::_wrapperBody(const void* context, unsigned char part, unsigned char* length) {
+    InfluxSender* obj = (InfluxSender*)context;
+    return obj->_body(part, length);
+}
+
+void InfluxSender::_wrapperDHTInChanged(const void* context, const Centi* temp, const Centi* hum) {
     InfluxSender* obj = (InfluxSender*)context;
     obj->_onDHTInChanged(temp, hum);
 }
 
-void InfluxSender::_wrapperDHTOutChanged(const void* context, const float* temp, const float* hum) {
+void InfluxSender::_wrapperDHTOutChanged(const void* context, const Centi* temp, const Centi* hum) {
     InfluxSender* obj = (InfluxSender*)context;
     obj->_onDHTOutChanged(temp, hum);
 }
@@ -280,4 +647,15 @@ void InfluxSender::_wrapperWaterChanged(const void* context, const unsigned char
 void InfluxSender::_wrapperSoilChanged(const void* context, const unsigned char* id, const SoilSensorState* state) {
     InfluxSender* obj = (InfluxSender*)context;
     obj->_onSoilChanged(id, state);
+}
+
+void InfluxSender::wrapperUpdate(const void* context) {
+    InfluxSender* obj = (InfluxSender*)context;
+    obj->Update();
+}
+
+void InfluxSender::wrapperStatusCommand(const void* context, Print* out, const char* args) {
+    InfluxSender* obj = (InfluxSender*)context;
+    if (strcmp_P(args, PSTR("reset")) == 0) obj->_wifi_counters = {0, 0, 0, 0, 0};
+    obj->printStatus(out);
 }
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
-#include <ArduinoSTL.h>
-
 #include "DataTypes.hpp"
+#include "Observers.hpp"
+#include "FastPin.hpp"
+#include "AdcScanner.hpp"
 
-#define V_REF_L 500.0
-#define ADC_STEPS_L 1023.0
+#define LED_R_PIN 41
+#define LED_G_PIN 39
+#define LED_B_PIN 40
+#define LIGHT_OBSERVERS 3 // processor, display, influx
 
 using LightCallback = void (*)(const void*, const unsigned char*);
 
@@ -15,9 +18,6 @@ private:
     const ConfigUShort _delay_cf = {wrapperReadDelay, 100, 60000, 50, "ms"};
 
     unsigned char _ph_pin;
-    unsigned char _r_pin;
-    unsigned char _g_pin;
-    unsigned char _b_pin;
 
     unsigned char _light_level = 100;
     unsigned short _read_delay = 2000; //ms
@@ -25,13 +25,14 @@ private:
     bool _is_r_on = false;
     bool _is_g_on = false;
     bool _is_b_on = false;
+    AdcScanner* _adc = nullptr;
 
-    std::vector<std::pair<const void*, LightCallback>> _callbacks;
+    Observers<LightCallback, LIGHT_OBSERVERS> _callbacks;
 public:
     const DataConfig delayConfig = {TYPE_USHORT, {.confUShort = &_delay_cf}};
 
-    Light(unsigned char phPin, unsigned char rLEDPin, unsigned char gLEDPin, unsigned char bLEDPin);
-    void Init();
+    Light(unsigned char phPin);
+    void Init(AdcScanner* adc);
     void update();
     void addCallback(const void *context, LightCallback valueChagedCallback);
 
@@ -40,41 +41,37 @@ public:
     bool gLED(const bool* state);
     bool bLED(const bool* state);
     unsigned char lightLevel();
+    static void wrapperUpdate(const void* context);
     static unsigned short wrapperReadDelay(const void* context, const unsigned short* delay);
 };
 
-Light::Light(unsigned char phPin, unsigned char rLEDPin, unsigned char gLEDPin, unsigned char bLEDPin)
+Light::Light(unsigned char phPin)
 {
     _ph_pin = phPin;
-    _r_pin = rLEDPin;
-    _g_pin = gLEDPin;
-    _b_pin = bLEDPin;
 }
 
-void Light::Init()
+void Light::Init(AdcScanner* adc)
 {
-    pinMode(_r_pin, OUTPUT);
-    pinMode(_g_pin, OUTPUT);
-    pinMode(_b_pin, OUTPUT);
-    digitalWrite(_r_pin, LOW);
-    digitalWrite(_g_pin, LOW);
-    digitalWrite(_b_pin, LOW);
-    Serial.println("Light sensor initialized");
+    _adc = adc;
+    FastPin<LED_R_PIN>::output();
+    FastPin<LED_G_PIN>::output();
+    FastPin<LED_B_PIN>::output();
+    FastPin<LED_R_PIN>::write(LOW);
+    FastPin<LED_G_PIN>::write(LOW);
+    FastPin<LED_B_PIN>::write(LOW);
+    Serial.println(F("Light sensor initialized"));
 }
 
 void Light::update()
 {
     if(millis() - _last_read >= _read_delay)
     {
-        unsigned short value = ((float)analogRead(_ph_pin) / ADC_STEPS_L) * V_REF_L;
-        unsigned char val = (value * 100) / V_REF_L;
+        // percent of full scale as raw * 100 / 4096: a 16 bit multiply and a shift, no division
+        unsigned char val = ((_adc->read(_ph_pin) >> 2) * 25 + 128) >> 8;
         if(val != _light_level){
             _light_level = val;
-            for (const auto& callback : _callbacks)
-            {
-                callback.second(callback.first, &_light_level);
-            }
-            Serial.print("Light level changed to: ");
+            _callbacks.notify(&_light_level);
+            Serial.print(F("Light level changed to: "));
             Serial.println(_light_level);
         }
         _last_read = millis();
@@ -83,7 +80,7 @@ void Light::update()
 
 void Light::addCallback(const void *context, LightCallback valueChagedCallback)
 {
-    _callbacks.push_back(std::make_pair(context, valueChagedCallback));
+    _callbacks.add(context, valueChagedCallback);
 }
 
 unsigned short Light::readDelay(const unsigned short *delay)
@@ -97,7 +94,7 @@ bool Light::rLED(const bool *state)
     if(state && _is_r_on != *state)
     {
         _is_r_on = *state;
-        digitalWrite(_r_pin, _is_r_on);
+        FastPin<LED_R_PIN>::write(_is_r_on);
     }
     return _is_r_on;
 }
@@ -107,7 +104,7 @@ bool Light::gLED(const bool *state)
     if(state && _is_g_on != *state)
     {
         _is_g_on = *state;
-        digitalWrite(_g_pin, _is_g_on);
+        FastPin<LED_G_PIN>::write(_is_g_on);
     }
     return _is_g_on;
 }
@@ -117,13 +114,19 @@ bool Light::bLED(const bool *state)
     if(state && _is_b_on != *state)
     {
         _is_b_on = *state;
-        digitalWrite(_b_pin, _is_b_on);
+        FastPin<LED_B_PIN>::write(_is_b_on);
     }
     return _is_b_on;
 }
 
 unsigned char Light::lightLevel() { return _light_level; }
 
+void Light::wrapperUpdate(const void *context)
+{
+    Light* obj = (Light*)context;
+    obj->update();
+}
+
 unsigned short Light::wrapperReadDelay(const void *context, const unsigned short *delay)
 {
     Light* obj = (Light*)context;
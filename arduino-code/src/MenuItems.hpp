@@ -1,8 +1,10 @@
 #pragma once
 
+#include <Arduino.h>
+
 #define ITEM_COUNT(arr) (sizeof(arr) / sizeof(arr[0]))
 
-enum MenuID {
+enum MenuID : unsigned char {
     ID_NONE = 0, 
 
     // --- Manual Mode Items ---
@@ -54,28 +56,62 @@ enum MenuID {
     // --- Sensors Settings ---
     SENSORS_SOIL1_DELAY,
     SENSORS_SOIL1_HYS,
+    SENSORS_SOIL1_T1,
+    SENSORS_SOIL1_T2,
+    SENSORS_SOIL1_T3,
+    SENSORS_SOIL1_T4,
     SENSORS_SOIL2_DELAY,
     SENSORS_SOIL2_HYS,
+    SENSORS_SOIL2_T1,
+    SENSORS_SOIL2_T2,
+    SENSORS_SOIL2_T3,
+    SENSORS_SOIL2_T4,
     SENSORS_SOIL3_DELAY,
     SENSORS_SOIL3_HYS,
+    SENSORS_SOIL3_T1,
+    SENSORS_SOIL3_T2,
+    SENSORS_SOIL3_T3,
+    SENSORS_SOIL3_T4,
+    SENSORS_SOIL_SETTLE,
     SENSORS_DHT_IN,
+    SENSORS_DHT_IN_TEMP_BAND,
+    SENSORS_DHT_IN_HUM_BAND,
+    SENSORS_DHT_IN_INTERVAL,
     SENSORS_DHT_OUT,
+    SENSORS_DHT_OUT_TEMP_BAND,
+    SENSORS_DHT_OUT_HUM_BAND,
+    SENSORS_DHT_OUT_INTERVAL,
     SENSORS_WATER,
     SENSORS_PHOTO, //TODO
 
     // --- System ---
-    //MENU_ID_COUNT 
+    MENU_ID_COUNT
 };
 
+#define MENU_HEADER_LENGTH 15 // "CZAS SWIECENIA" + '\0'
+#define MENU_NAME_LENGTH 19   // "Interwal Swiecenia" + '\0'
+
+// The whole tree lives in flash (PROGMEM), texts included, so nothing of it is copied to SRAM at
+// start-up. Fields must not be read directly on the board, only through the menu*() helpers below.
 struct MenuItem {
     const MenuItem* parent;
-    const char* header;
-    const char* menuName;
+    const char header[MENU_HEADER_LENGTH];
+    const char menuName[MENU_NAME_LENGTH];
     const MenuItem* const* items;
     const MenuID id;                
     unsigned char count;    
 };
 
+inline const MenuItem* menuParent(const MenuItem* item) { return (const MenuItem*)pgm_read_ptr(&item->parent); }
+inline const MenuItem* const* menuItems(const MenuItem* item) { return (const MenuItem* const*)pgm_read_ptr(&item->items); }
+inline const MenuItem* menuChild(const MenuItem* item, unsigned char index) { return (const MenuItem*)pgm_read_ptr(&menuItems(item)[index]); }
+inline MenuID menuId(const MenuItem* item) { return (MenuID)pgm_read_byte(&item->id); }
+inline unsigned char menuCount(const MenuItem* item) { return pgm_read_byte(&item->count); }
+
+// texts go straight to print(), or TextBuffer::textP() when they have to be measured
+inline const __FlashStringHelper* menuHeader(const MenuItem* item) { return (const __FlashStringHelper*)item->header; }
+inline const __FlashStringHelper* menuName(const MenuItem* item) { return (const __FlashStringHelper*)item->menuName; }
+
 // --- FORWARD DECLARATIONS ---
 extern const MenuItem mainMenu;
 extern const MenuItem itemManualMode;
@@ -91,18 +127,20 @@ extern const MenuItem itemSensorsSettings;
 extern const MenuItem itemSensorsSoil1;
 extern const MenuItem itemSensorsSoil2;
 extern const MenuItem itemSensorsSoil3;
+extern const MenuItem itemSensorsDHTIn;
+extern const MenuItem itemSensorsDHTOut;
 
-const MenuItem itemBack = { nullptr, "POWROT", "Powrot", nullptr, ID_NONE, 0};
+const MenuItem itemBack PROGMEM = { nullptr, "POWROT", "Powrot", nullptr, ID_NONE, 0};
 
 // --- MANUAL MODE ---
-//const MenuItem itemActuatorDirection = {&itemManualMode, "KIERUNEK", "Kierunek Klapy", nullptr, ACTUATOR_DIRECTION, 0};
-const MenuItem itemActuator          = {&itemManualMode, "KLAPA", "Klapa Praca",       nullptr, ACTUATOR, 0};
-const MenuItem itemLED               = {&itemManualMode, "LED", "LED Praca",           nullptr, LED, 0};
-const MenuItem itemPump              = {&itemManualMode, "POMPA", "Pompa Praca",       nullptr, PUMP, 0};
-const MenuItem itemHeater            = {&itemManualMode, "GRZALKA", "Grzalka Praca",   nullptr, HEATER, 0};
-//const MenuItem itemVariableView    = {&itemManualMode, "DANE", "Podglad Danych",    nullptr, VARIABLE_VIEW, 0};
-
-const MenuItem* const manualModeItems[] = {
+//const MenuItem itemActuatorDirection PROGMEM = {&itemManualMode, "KIERUNEK", "Kierunek Klapy", nullptr, ACTUATOR_DIRECTION, 0};
+const MenuItem itemActuator PROGMEM          = {&itemManualMode, "KLAPA", "Klapa Praca",       nullptr, ACTUATOR, 0};
+const MenuItem itemLED PROGMEM               = {&itemManualMode, "LED", "LED Praca",           nullptr, LED, 0};
+const MenuItem itemPump PROGMEM              = {&itemManualMode, "POMPA", "Pompa Praca",       nullptr, PUMP, 0};
+const MenuItem itemHeater PROGMEM            = {&itemManualMode, "GRZALKA", "Grzalka Praca",   nullptr, HEATER, 0};
+//const MenuItem itemVariableView PROGMEM    = {&itemManualMode, "DANE", "Podglad Danych",    nullptr, VARIABLE_VIEW, 0};
+
+const MenuItem* const manualModeItems[] PROGMEM = {
     &itemBack,
     //&itemActuatorDirection,
     &itemActuator,
@@ -112,20 +150,20 @@ const MenuItem* const manualModeItems[] = {
     //&itemVariableView
 };
 
-const MenuItem itemManualMode = {&mainMenu, "TRYB RECZNY", "Tryb reczny", manualModeItems, ID_NONE, ITEM_COUNT(manualModeItems)};
+const MenuItem itemManualMode PROGMEM = {&mainMenu, "TRYB RECZNY", "Tryb reczny", manualModeItems, ID_NONE, ITEM_COUNT(manualModeItems)};
 
 // --- ACTUATOR SETTINGS ---
-/*const MenuItem itemActuatorTempOn  = {&itemActuatorSettings, "TEMP. OTW.", "Temp. Otwarcia",    nullptr, ACTUATOR_TEMP_ON, 0};
-const MenuItem itemActuatorTempOff = {&itemActuatorSettings, "TEMP. ZAM.", "Temp. Zamkniecia",  nullptr, ACTUATOR_TEMP_OFF, 0};
-const MenuItem itemActuatorHumOn   = {&itemActuatorSettings, "WIL. OTW.", "Wilgoc Otwarcia",    nullptr, ACTUATOR_HUM_ON, 0};
-const MenuItem itemActuatorHumOff  = {&itemActuatorSettings, "WIL. ZAM.", "Wilgoc Zamkniecia",  nullptr, ACTUATOR_HUM_OFF, 0};
+/*const MenuItem itemActuatorTempOn PROGMEM  = {&itemActuatorSettings, "TEMP. OTW.", "Temp. Otwarcia",    nullptr, ACTUATOR_TEMP_ON, 0};
+const MenuItem itemActuatorTempOff PROGMEM = {&itemActuatorSettings, "TEMP. ZAM.", "Temp. Zamkniecia",  nullptr, ACTUATOR_TEMP_OFF, 0};
+const MenuItem itemActuatorHumOn PROGMEM   = {&itemActuatorSettings, "WIL. OTW.", "Wilgoc Otwarcia",    nullptr, ACTUATOR_HUM_ON, 0};
+const MenuItem itemActuatorHumOff PROGMEM  = {&itemActuatorSettings, "WIL. ZAM.", "Wilgoc Zamkniecia",  nullptr, ACTUATOR_HUM_OFF, 0};
 */
 
 // --- Relay Settings ---
-const MenuItem itemSwitchingDelay = {&itemRelaySettings, "T PRZEL. STY.", "Czas Przel. Styku", nullptr, SWITCHING_DELAY, 0};
-const MenuItem itemSwitchingOffDelay = {&itemRelaySettings, "T WYL. STY.", "Czas Wyl. Styku", nullptr, SWITCHING_OFF_DELAY, 0};
+const MenuItem itemSwitchingDelay PROGMEM = {&itemRelaySettings, "T PRZEL. STY.", "Czas Przel. Styku", nullptr, SWITCHING_DELAY, 0};
+const MenuItem itemSwitchingOffDelay PROGMEM = {&itemRelaySettings, "T WYL. STY.", "Czas Wyl. Styku", nullptr, SWITCHING_OFF_DELAY, 0};
 
-const MenuItem* const relaySettingsItems[] = {
+const MenuItem* const relaySettingsItems[] PROGMEM = {
     &itemBack,
     &itemSwitchingDelay,
     &itemSwitchingOffDelay
@@ -135,15 +173,15 @@ const MenuItem* const relaySettingsItems[] = {
     &itemActuatorHumOff*/
 };
 
-const MenuItem itemRelaySettings = {&itemSettings, "STYKI", "Styki", relaySettingsItems, ID_NONE, ITEM_COUNT(relaySettingsItems)};
+const MenuItem itemRelaySettings PROGMEM = {&itemSettings, "STYKI", "Styki", relaySettingsItems, ID_NONE, ITEM_COUNT(relaySettingsItems)};
 
 // --- HEAT AND HUM SETTINGS ---
-const MenuItem itemTempSetpoint = {&itemTempAndHumSettings, "TEMP. ZAD.", "Temp. Zadana", nullptr, TEMP_SETPOINT, 0};
-const MenuItem itemTempHys = {&itemTempAndHumSettings, "HIS. TEMP.", "Histereza Temp.", nullptr, TEMP_HYS, 0};
-const MenuItem itemHumSetpoint = {&itemTempAndHumSettings, "WIL. ZAD.", "Wil. Zadana", nullptr, HUM_SETPOINT, 0};
-const MenuItem itemHumHys = {&itemTempAndHumSettings, "HIS. WIL.", "Histereza Wil.", nullptr, HUM_HYS, 0};
+const MenuItem itemTempSetpoint PROGMEM = {&itemTempAndHumSettings, "TEMP. ZAD.", "Temp. Zadana", nullptr, TEMP_SETPOINT, 0};
+const MenuItem itemTempHys PROGMEM = {&itemTempAndHumSettings, "HIS. TEMP.", "Histereza Temp.", nullptr, TEMP_HYS, 0};
+const MenuItem itemHumSetpoint PROGMEM = {&itemTempAndHumSettings, "WIL. ZAD.", "Wil. Zadana", nullptr, HUM_SETPOINT, 0};
+const MenuItem itemHumHys PROGMEM = {&itemTempAndHumSettings, "HIS. WIL.", "Histereza Wil.", nullptr, HUM_HYS, 0};
 
-const MenuItem* const tempAndHumItems[] = {
+const MenuItem* const tempAndHumItems[] PROGMEM = {
     &itemBack,
     &itemTempSetpoint,
     &itemTempHys,
@@ -151,27 +189,27 @@ const MenuItem* const tempAndHumItems[] = {
     &itemHumHys
 };
 
-const MenuItem itemTempAndHumSettings = {&itemSettings, "TEMP. i WIL.", "Temp. i Wil.", tempAndHumItems, ID_NONE, ITEM_COUNT(tempAndHumItems)};
+const MenuItem itemTempAndHumSettings PROGMEM = {&itemSettings, "TEMP. i WIL.", "Temp. i Wil.", tempAndHumItems, ID_NONE, ITEM_COUNT(tempAndHumItems)};
 
 // --- HEATER SETTINGS ---
-/*const MenuItem itemHeaterTemp    = {&itemHeaterSettings, "TEMP. ZAD.", "Temp.zadana",     nullptr, HEATER_TEMP, 0};
-const MenuItem itemHeaterHysTemp = {&itemHeaterSettings, "HIS. TEMP.", "Histereza Temp.", nullptr, HEATER_HYS_TEMP, 0};
+/*const MenuItem itemHeaterTemp PROGMEM    = {&itemHeaterSettings, "TEMP. ZAD.", "Temp.zadana",     nullptr, HEATER_TEMP, 0};
+const MenuItem itemHeaterHysTemp PROGMEM = {&itemHeaterSettings, "HIS. TEMP.", "Histereza Temp.", nullptr, HEATER_HYS_TEMP, 0};
 
-const MenuItem* const heaterSettingsItems[] = {
+const MenuItem* const heaterSettingsItems[] PROGMEM = {
     &itemBack,
     &itemHeaterTemp,
     &itemHeaterHysTemp
 };
 
-const MenuItem itemHeaterSettings = {&itemSettings, "GRZALKA", "Grzalka", heaterSettingsItems, ID_NONE, ITEM_COUNT(heaterSettingsItems)};*/
+const MenuItem itemHeaterSettings PROGMEM = {&itemSettings, "GRZALKA", "Grzalka", heaterSettingsItems, ID_NONE, ITEM_COUNT(heaterSettingsItems)};*/
 
 // --- PUMP SETTINGS ---
-const MenuItem itemPumpSensorCount = {&itemPumpSettings, "IL. ZG. CZUJ.", "Il. Zgodnych Czuj.", nullptr, PUMP_SENSOR_COUNT, 0};
-const MenuItem itemPumpSetpoint   = {&itemPumpSettings, "PROG ZAL.", "Prog Zalaczenia",        nullptr, PUMP_SETPOINT, 0};
-const MenuItem itemPumpRunTime        = {&itemPumpSettings, "CZAS PODL.", "Czas Podlewania",       nullptr, PUMP_RUN_TIME, 0};
-const MenuItem itemPumpRunInterval    = {&itemPumpSettings, "INTERWAL", "Interwal Podl.",          nullptr, PUMP_RUN_INTERVAL, 0};
+const MenuItem itemPumpSensorCount PROGMEM = {&itemPumpSettings, "IL. ZG. CZUJ.", "Il. Zgodnych Czuj.", nullptr, PUMP_SENSOR_COUNT, 0};
+const MenuItem itemPumpSetpoint PROGMEM   = {&itemPumpSettings, "PROG ZAL.", "Prog Zalaczenia",        nullptr, PUMP_SETPOINT, 0};
+const MenuItem itemPumpRunTime PROGMEM        = {&itemPumpSettings, "CZAS PODL.", "Czas Podlewania",       nullptr, PUMP_RUN_TIME, 0};
+const MenuItem itemPumpRunInterval PROGMEM    = {&itemPumpSettings, "INTERWAL", "Interwal Podl.",          nullptr, PUMP_RUN_INTERVAL, 0};
 
-const MenuItem* const pumpSettingsItems[] = {
+const MenuItem* const pumpSettingsItems[] PROGMEM = {
     &itemBack,
     &itemPumpSensorCount,
     &itemPumpSetpoint,
@@ -179,15 +217,15 @@ const MenuItem* const pumpSettingsItems[] = {
     &itemPumpRunInterval
 };
 
-const MenuItem itemPumpSettings = {&itemSettings, "POMPA", "Pompa", pumpSettingsItems, ID_NONE, ITEM_COUNT(pumpSettingsItems)};
+const MenuItem itemPumpSettings PROGMEM = {&itemSettings, "POMPA", "Pompa", pumpSettingsItems, ID_NONE, ITEM_COUNT(pumpSettingsItems)};
 
 // --- LED SETTINGS ---
-const MenuItem itemLEDThreshold = {&itemLEDSettings, "PROG SWIATLA", "Prog Swiatla",       nullptr, LED_THRESHOLD, 0};
-const MenuItem itemLEDHys       = {&itemLEDSettings, "HIS. SWIATLA", "Histereza Swiatla",  nullptr, LED_HYS, 0};
-const MenuItem itemLEDRunTime      = {&itemLEDSettings, "CZAS SWIECENIA", "Czas Swiecenia",   nullptr, LED_RUN_TIME, 0};
-const MenuItem itemLEDRunInterval  = {&itemLEDSettings, "INTERWAL", "Interwal Swiecenia",     nullptr, LED_RUN_INTERVAL, 0};
+const MenuItem itemLEDThreshold PROGMEM = {&itemLEDSettings, "PROG SWIATLA", "Prog Swiatla",       nullptr, LED_THRESHOLD, 0};
+const MenuItem itemLEDHys PROGMEM       = {&itemLEDSettings, "HIS. SWIATLA", "Histereza Swiatla",  nullptr, LED_HYS, 0};
+const MenuItem itemLEDRunTime PROGMEM      = {&itemLEDSettings, "CZAS SWIECENIA", "Czas Swiecenia",   nullptr, LED_RUN_TIME, 0};
+const MenuItem itemLEDRunInterval PROGMEM  = {&itemLEDSettings, "INTERWAL", "Interwal Swiecenia",     nullptr, LED_RUN_INTERVAL, 0};
 
-const MenuItem* const LEDSettingsItems[] = {
+const MenuItem* const LEDSettingsItems[] PROGMEM = {
     &itemBack,
     &itemLEDThreshold,
     &itemLEDHys,
@@ -195,15 +233,15 @@ const MenuItem* const LEDSettingsItems[] = {
     &itemLEDRunInterval
 };
 
-const MenuItem itemLEDSettings = {&itemSettings, "LED", "LED", LEDSettingsItems, ID_NONE, ITEM_COUNT(LEDSettingsItems)};
+const MenuItem itemLEDSettings PROGMEM = {&itemSettings, "LED", "LED", LEDSettingsItems, ID_NONE, ITEM_COUNT(LEDSettingsItems)};
 
 // --- DISPLAY SETTINGS ---
-const MenuItem itemDisplayBrightness      = {&itemDisplaySettings, "JASNOSC", "Jasnosc",            nullptr, DISPLAY_BRIGHTNESS, 0};
-const MenuItem itemDisplaySaverBrightness = {&itemDisplaySettings, "JASNOSC WYG.", "Jasnosc Wyg.",  nullptr, DISPLAY_SAVER_BRIGHTNESS, 0};
-const MenuItem itemDisplaySaverTime       = {&itemDisplaySettings, "CZAS WYG.", "Czas Wygaszacza",  nullptr, DISPLAY_SAVER_TIME, 0};
-const MenuItem itemDisplaySwitchTime      = {&itemDisplaySettings, "CZAS ZM. SC.", "Czas Zmiany Scen", nullptr, DISPLAY_SWITCH_TIME, 0};
+const MenuItem itemDisplayBrightness PROGMEM      = {&itemDisplaySettings, "JASNOSC", "Jasnosc",            nullptr, DISPLAY_BRIGHTNESS, 0};
+const MenuItem itemDisplaySaverBrightness PROGMEM = {&itemDisplaySettings, "JASNOSC WYG.", "Jasnosc Wyg.",  nullptr, DISPLAY_SAVER_BRIGHTNESS, 0};
+const MenuItem itemDisplaySaverTime PROGMEM       = {&itemDisplaySettings, "CZAS WYG.", "Czas Wygaszacza",  nullptr, DISPLAY_SAVER_TIME, 0};
+const MenuItem itemDisplaySwitchTime PROGMEM      = {&itemDisplaySettings, "CZAS ZM. SC.", "Czas Zmiany Scen", nullptr, DISPLAY_SWITCH_TIME, 0};
 
-const MenuItem* const displaySettingsItems[] = {
+const MenuItem* const displaySettingsItems[] PROGMEM = {
     &itemBack,
     &itemDisplayBrightness,
     &itemDisplaySaverBrightness,
@@ -211,62 +249,115 @@ const MenuItem* const displaySettingsItems[] = {
     &itemDisplaySwitchTime
 };
 
-const MenuItem itemDisplaySettings = {&itemSettings, "OLED", "Wyswietlacz", displaySettingsItems, ID_NONE, ITEM_COUNT(displaySettingsItems)};
+const MenuItem itemDisplaySettings PROGMEM = {&itemSettings, "OLED", "Wyswietlacz", displaySettingsItems, ID_NONE, ITEM_COUNT(displaySettingsItems)};
 
 // --- SENSORS SETTINGS ---
-/*const MenuItem itemSensorsSoil1  = {&itemSensorsSettings, "SOIL1", "Soil1",   nullptr, SENSORS_SOIL1, 0};
-const MenuItem itemSensorsSoil2  = {&itemSensorsSettings, "SOIL2", "Soil2",   nullptr, SENSORS_SOIL2, 0};
-const MenuItem itemSensorsSoil3  = {&itemSensorsSettings, "SOIL3", "Soil3",   nullptr, SENSORS_SOIL3, 0};*/
-const MenuItem itemSensorsSoil1Delay = {&itemSensorsSoil1, "S1 DELAY", "Soil1 Delay",   nullptr, SENSORS_SOIL1_DELAY, 0};
-const MenuItem itemSensorsSoil1Hys = {&itemSensorsSoil1, "S1 HYS", "Soil1 Hys",   nullptr, SENSORS_SOIL1_HYS, 0};
-
-const MenuItem* const sensorsSoil1Items[] = {
+/*const MenuItem itemSensorsSoil1 PROGMEM  = {&itemSensorsSettings, "SOIL1", "Soil1",   nullptr, SENSORS_SOIL1, 0};
+const MenuItem itemSensorsSoil2 PROGMEM  = {&itemSensorsSettings, "SOIL2", "Soil2",   nullptr, SENSORS_SOIL2, 0};
+const MenuItem itemSensorsSoil3 PROGMEM  = {&itemSensorsSettings, "SOIL3", "Soil3",   nullptr, SENSORS_SOIL3, 0};*/
+const MenuItem itemSensorsSoil1Delay PROGMEM = {&itemSensorsSoil1, "S1 DELAY", "Soil1 Delay",   nullptr, SENSORS_SOIL1_DELAY, 0};
+const MenuItem itemSensorsSoil1Hys PROGMEM = {&itemSensorsSoil1, "S1 HYS", "Soil1 Hys",   nullptr, SENSORS_SOIL1_HYS, 0};
+const MenuItem itemSensorsSoil1T1 PROGMEM = {&itemSensorsSoil1, "S1 THR 1", "Soil1 Thr 1",   nullptr, SENSORS_SOIL1_T1, 0};
+const MenuItem itemSensorsSoil1T2 PROGMEM = {&itemSensorsSoil1, "S1 THR 2", "Soil1 Thr 2",   nullptr, SENSORS_SOIL1_T2, 0};
+const MenuItem itemSensorsSoil1T3 PROGMEM = {&itemSensorsSoil1, "S1 THR 3", "Soil1 Thr 3",   nullptr, SENSORS_SOIL1_T3, 0};
+const MenuItem itemSensorsSoil1T4 PROGMEM = {&itemSensorsSoil1, "S1 THR 4", "Soil1 Thr 4",   nullptr, SENSORS_SOIL1_T4, 0};
+
+const MenuItem* const sensorsSoil1Items[] PROGMEM = {
     &itemBack,
     &itemSensorsSoil1Delay,
-    &itemSensorsSoil1Hys
+    &itemSensorsSoil1Hys,
+    &itemSensorsSoil1T1,
+    &itemSensorsSoil1T2,
+    &itemSensorsSoil1T3,
+    &itemSensorsSoil1T4
 };
 
-const MenuItem itemSensorsSoil2Delay = {&itemSensorsSoil2, "S2 DELAY", "Soil2 Delay",   nullptr, SENSORS_SOIL2_DELAY, 0};
-const MenuItem itemSensorsSoil2Hys = {&itemSensorsSoil2, "S2 HYS", "Soil2 Hys",   nullptr, SENSORS_SOIL2_HYS, 0};
+const MenuItem itemSensorsSoil2Delay PROGMEM = {&itemSensorsSoil2, "S2 DELAY", "Soil2 Delay",   nullptr, SENSORS_SOIL2_DELAY, 0};
+const MenuItem itemSensorsSoil2Hys PROGMEM = {&itemSensorsSoil2, "S2 HYS", "Soil2 Hys",   nullptr, SENSORS_SOIL2_HYS, 0};
+const MenuItem itemSensorsSoil2T1 PROGMEM = {&itemSensorsSoil2, "S2 THR 1", "Soil2 Thr 1",   nullptr, SENSORS_SOIL2_T1, 0};
+const MenuItem itemSensorsSoil2T2 PROGMEM = {&itemSensorsSoil2, "S2 THR 2", "Soil2 Thr 2",   nullptr, SENSORS_SOIL2_T2, 0};
+const MenuItem itemSensorsSoil2T3 PROGMEM = {&itemSensorsSoil2, "S2 THR 3", "Soil2 Thr 3",   nullptr, SENSORS_SOIL2_T3, 0};
+const MenuItem itemSensorsSoil2T4 PROGMEM = {&itemSensorsSoil2, "S2 THR 4", "Soil2 Thr 4",   nullptr, SENSORS_SOIL2_T4, 0};
 
-const MenuItem* const sensorsSoil2Items[] = {
+const MenuItem* const sensorsSoil2Items[] PROGMEM = {
     &itemBack,
     &itemSensorsSoil2Delay,
-    &itemSensorsSoil2Hys
+    &itemSensorsSoil2Hys,
+    &itemSensorsSoil2T1,
+    &itemSensorsSoil2T2,
+    &itemSensorsSoil2T3,
+    &itemSensorsSoil2T4
 };
 
-const MenuItem itemSensorsSoil3Delay = {&itemSensorsSoil3, "S3 DELAY", "Soil3 Delay",   nullptr, SENSORS_SOIL3_DELAY, 0};
-const MenuItem itemSensorsSoil3Hys = {&itemSensorsSoil3, "S3 HYS", "Soil3 Hys",   nullptr, SENSORS_SOIL3_HYS, 0};
+const MenuItem itemSensorsSoil3Delay PROGMEM = {&itemSensorsSoil3, "S3 DELAY", "Soil3 Delay",   nullptr, SENSORS_SOIL3_DELAY, 0};
+const MenuItem itemSensorsSoil3Hys PROGMEM = {&itemSensorsSoil3, "S3 HYS", "Soil3 Hys",   nullptr, SENSORS_SOIL3_HYS, 0};
+const MenuItem itemSensorsSoil3T1 PROGMEM = {&itemSensorsSoil3, "S3 THR 1", "Soil3 Thr 1",   nullptr, SENSORS_SOIL3_T1, 0};
+const MenuItem itemSensorsSoil3T2 PROGMEM = {&itemSensorsSoil3, "S3 THR 2", "Soil3 Thr 2",   nullptr, SENSORS_SOIL3_T2, 0};
+const MenuItem itemSensorsSoil3T3 PROGMEM = {&itemSensorsSoil3, "S3 THR 3", "Soil3 Thr 3",   nullptr, SENSORS_SOIL3_T3, 0};
+const MenuItem itemSensorsSoil3T4 PROGMEM = {&itemSensorsSoil3, "S3 THR 4", "Soil3 Thr 4",   nullptr, SENSORS_SOIL3_T4, 0};
 
-const MenuItem* const sensorsSoil3Items[] = {
+const MenuItem* const sensorsSoil3Items[] PROGMEM = {
     &itemBack,
     &itemSensorsSoil3Delay,
-    &itemSensorsSoil3Hys
+    &itemSensorsSoil3Hys,
+    &itemSensorsSoil3T1,
+    &itemSensorsSoil3T2,
+    &itemSensorsSoil3T3,
+    &itemSensorsSoil3T4
+};
+
+const MenuItem itemSensorsSoil1 PROGMEM  = {&itemSensorsSettings, "SOIL1", "Soil1", sensorsSoil1Items, ID_NONE, ITEM_COUNT(sensorsSoil1Items)};
+const MenuItem itemSensorsSoil2 PROGMEM  = {&itemSensorsSettings, "SOIL2", "Soil2", sensorsSoil2Items, ID_NONE, ITEM_COUNT(sensorsSoil2Items)};
+const MenuItem itemSensorsSoil3 PROGMEM  = {&itemSensorsSettings, "SOIL3", "Soil3", sensorsSoil3Items, ID_NONE, ITEM_COUNT(sensorsSoil3Items)};
+const MenuItem itemSensorsSoilSettle PROGMEM = {&itemSensorsSettings, "SOIL SETTLE", "Soil Settle",   nullptr, SENSORS_SOIL_SETTLE, 0};
+
+const MenuItem itemSensorsDHTInDelay PROGMEM = {&itemSensorsDHTIn, "T IN DEL", "T In R Delay",   nullptr, SENSORS_DHT_IN, 0};
+const MenuItem itemSensorsDHTInTempBand PROGMEM = {&itemSensorsDHTIn, "T IN BAND T", "T In Band Temp",   nullptr, SENSORS_DHT_IN_TEMP_BAND, 0};
+const MenuItem itemSensorsDHTInHumBand PROGMEM = {&itemSensorsDHTIn, "T IN BAND H", "T In Band Hum",   nullptr, SENSORS_DHT_IN_HUM_BAND, 0};
+const MenuItem itemSensorsDHTInInterval PROGMEM = {&itemSensorsDHTIn, "T IN NOTIFY", "T In Notify Int",   nullptr, SENSORS_DHT_IN_INTERVAL, 0};
+
+const MenuItem* const sensorsDHTInItems[] PROGMEM = {
+    &itemBack,
+    &itemSensorsDHTInDelay,
+    &itemSensorsDHTInTempBand,
+    &itemSensorsDHTInHumBand,
+    &itemSensorsDHTInInterval
+};
+
+const MenuItem itemSensorsDHTOutDelay PROGMEM = {&itemSensorsDHTOut, "T OUT DEL", "T Out R Delay",   nullptr, SENSORS_DHT_OUT, 0};
+const MenuItem itemSensorsDHTOutTempBand PROGMEM = {&itemSensorsDHTOut, "T OUT BAND T", "T Out Band Temp",   nullptr, SENSORS_DHT_OUT_TEMP_BAND, 0};
+const MenuItem itemSensorsDHTOutHumBand PROGMEM = {&itemSensorsDHTOut, "T OUT BAND H", "T Out Band Hum",   nullptr, SENSORS_DHT_OUT_HUM_BAND, 0};
+const MenuItem itemSensorsDHTOutInterval PROGMEM = {&itemSensorsDHTOut, "T OUT NOTIFY", "T Out Notify Int",   nullptr, SENSORS_DHT_OUT_INTERVAL, 0};
+
+const MenuItem* const sensorsDHTOutItems[] PROGMEM = {
+    &itemBack,
+    &itemSensorsDHTOutDelay,
+    &itemSensorsDHTOutTempBand,
+    &itemSensorsDHTOutHumBand,
+    &itemSensorsDHTOutInterval
 };
 
-const MenuItem itemSensorsSoil1  = {&itemSensorsSettings, "SOIL1", "Soil1", sensorsSoil1Items, ID_NONE, ITEM_COUNT(sensorsSoil1Items)};
-const MenuItem itemSensorsSoil2  = {&itemSensorsSettings, "SOIL2", "Soil2", sensorsSoil2Items, ID_NONE, ITEM_COUNT(sensorsSoil2Items)};
-const MenuItem itemSensorsSoil3  = {&itemSensorsSettings, "SOIL3", "Soil3", sensorsSoil3Items, ID_NONE, ITEM_COUNT(sensorsSoil3Items)};
-const MenuItem itemSensorsDHTIn  = {&itemSensorsSettings, "T IN DEL", "T In R Delay",   nullptr, SENSORS_DHT_IN, 0};
-const MenuItem itemSensorsDHTOut = {&itemSensorsSettings, "T OUT DEL", "T Out R Delay", nullptr, SENSORS_DHT_OUT, 0};
-const MenuItem itemSensorsWater  = {&itemSensorsSettings, "WATER DEL", "Water R Delay",   nullptr, SENSORS_WATER, 0};
-const MenuItem itemSensorsPhoto  = {&itemSensorsSettings, "PHOTO DEL", "Photo R Delay",   nullptr, SENSORS_PHOTO, 0};
+const MenuItem itemSensorsDHTIn PROGMEM  = {&itemSensorsSettings, "T IN", "T In", sensorsDHTInItems, ID_NONE, ITEM_COUNT(sensorsDHTInItems)};
+const MenuItem itemSensorsDHTOut PROGMEM = {&itemSensorsSettings, "T OUT", "T Out", sensorsDHTOutItems, ID_NONE, ITEM_COUNT(sensorsDHTOutItems)};
+const MenuItem itemSensorsWater PROGMEM  = {&itemSensorsSettings, "WATER DEL", "Water R Delay",   nullptr, SENSORS_WATER, 0};
+const MenuItem itemSensorsPhoto PROGMEM  = {&itemSensorsSettings, "PHOTO DEL", "Photo R Delay",   nullptr, SENSORS_PHOTO, 0};
 
-const MenuItem* const sensorsSettingsItems[] = {
+const MenuItem* const sensorsSettingsItems[] PROGMEM = {
     &itemBack,
     &itemSensorsSoil1,
     &itemSensorsSoil2,
     &itemSensorsSoil3,
+    &itemSensorsSoilSettle,
     &itemSensorsDHTIn,
     &itemSensorsDHTOut,
     &itemSensorsWater,
     &itemSensorsPhoto
 };
 
-const MenuItem itemSensorsSettings = {&itemSettings, "CZUJNIKI", "Zwloka Czujnikow", sensorsSettingsItems, ID_NONE, ITEM_COUNT(sensorsSettingsItems)};
+const MenuItem itemSensorsSettings PROGMEM = {&itemSettings, "CZUJNIKI", "Zwloka Czujnikow", sensorsSettingsItems, ID_NONE, ITEM_COUNT(sensorsSettingsItems)};
 
 // --- MAIN STRUCTURE ---
-const MenuItem* const settingsItems[] = {
+const MenuItem* const settingsItems[] PROGMEM = {
     &itemBack,
     /*&itemActuatorSettings,
     &itemHeaterSettings,*/
@@ -277,18 +368,18 @@ const MenuItem* const settingsItems[] = {
     &itemSensorsSettings
 };
 
-const MenuItem itemSettings = {&mainMenu, "USTAWIENIA", "Ustawienia", settingsItems, ID_NONE, ITEM_COUNT(settingsItems)};
+const MenuItem itemSettings PROGMEM = {&mainMenu, "USTAWIENIA", "Ustawienia", settingsItems, ID_NONE, ITEM_COUNT(settingsItems)};
 
-const MenuItem* const mainItems[] = {
+const MenuItem* const mainItems[] PROGMEM = {
     &itemBack,
     &itemManualMode,
     &itemSettings
 };
 
-const MenuItem mainMenu = { 
+const MenuItem mainMenu PROGMEM = { 
     nullptr,
     "GLOWNE MENU", 
-    nullptr, 
+    "", 
     mainItems,
     ID_NONE, 
     ITEM_COUNT(mainItems)
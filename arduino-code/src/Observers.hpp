@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Fixed size list of (context, callback) subscribers. Storage is part of the owning object,
+// so the RAM it takes is known at link time and registering or notifying never allocates.
+// Sig is the callback pointer type, its first parameter is the subscriber context:
+//   Observers<DHTCallback, 3> _callbacks;
+//   _callbacks.add(this, _wrapperDHTChanged);
+//   _callbacks.notify(&_temperature, &_humidity);
+template <typename Sig, unsigned char N>
+class Observers
+{
+private:
+    struct Entry
+    {
+        const void* context;
+        Sig callback;
+    };
+
+    Entry _entries[N];
+    unsigned char _count = 0;
+
+public:
+    bool add(const void* context, Sig callback);
+    unsigned char count() const;
+
+    template <typename... Args>
+    void notify(Args... args) const;
+};
+
+// Returns false (and says so on Serial) when all N slots are taken, the capacity is too small then.
+template <typename Sig, unsigned char N>
+bool Observers<Sig, N>::add(const void* context, Sig callback)
+{
+    if (_count >= N)
+    {
+        Serial.println(F("Observers: list full"));
+        return false;
+    }
+    _entries[_count].context = context;
+    _entries[_count].callback = callback;
+    _count++;
+    return true;
+}
+
+template <typename Sig, unsigned char N>
+inline unsigned char Observers<Sig, N>::count() const { return _count; }
+
+template <typename Sig, unsigned char N>
+template <typename... Args>
+inline void Observers<Sig, N>::notify(Args... args) const
+{
+    for (unsigned char i = 0; i < _count; i++) _entries[i].callback(_entries[i].context, args...);
+}
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "DataTypes.hpp"
+#include "MenuItems.hpp"
+#include "Observers.hpp"
+#include "TextBuffer.hpp"
+
+#define PARAM_NAME_LENGTH 16  // "relay_off_delay" + '\0'
+#define PARAM_VALUE_LENGTH 16 // value with its unit as text, longer ones are cut
+#define PARAM_NOT_STORED 0    // key of parameters that are never persisted
+#define PARAM_OBSERVERS 2
+
+// Param::flags
+#define PARAM_LIVE 0x01 // editor applies every step and switches it off on exit (manual relay control)
+
+// One setting: the object it belongs to, its DataConfig, a persistence key and the name used on the
+// console and in telemetry. The table is PROGMEM, indexed by MenuID (entry i has id i + 1), so every
+// lookup is one index whatever the size of the menu. Adding a setting is a MenuID, a menu item and
+// one PARAM() line in main.cpp. Keys are stored next to the values, never reuse or renumber one.
+struct Param
+{
+    MenuID id;
+    unsigned char flags;
+    unsigned char key;
+    const void* context;
+    const DataConfig* config;
+    char name[PARAM_NAME_LENGTH];
+};
+
+#define PARAM(id, object, config, key, flags, name) {id, flags, key, &object, &object.config, name}
+
+inline MenuID paramId(const Param* param) { return (MenuID)pgm_read_byte(&param->id); }
+inline unsigned char paramFlags(const Param* param) { return pgm_read_byte(&param->flags); }
+inline unsigned char paramKey(const Param* param) { return pgm_read_byte(&param->key); }
+inline const void* paramContext(const Param* param) { return pgm_read_ptr(&param->context); }
+inline const DataConfig* paramConfig(const Param* param) { return (const DataConfig*)pgm_read_ptr(&param->config); }
+inline const __FlashStringHelper* paramName(const Param* param) { return (const __FlashStringHelper*)param->name; }
+
+struct Param;
+using ParamCallback = void (*)(const void*, const Param*);
+
+// Values go in and out as long: TYPE_FLOAT in Centi, TYPE_ENUM as the option index, TYPE_BOOL 0/1.
+class ParamRegistry
+{
+private:
+    const Param* _table = nullptr;
+    unsigned char _count = 0;
+    Observers<ParamCallback, PARAM_OBSERVERS> _committed;
+
+public:
+    void Init(const Param* table, unsigned char count);
+    unsigned char count();
+    const Param* at(unsigned char index);
+    const Param* get(MenuID id);
+    const Param* find(const char* name);
+    const Param* byKey(unsigned char key);
+    void addCommitCallback(const void* context, ParamCallback callback);
+    void commit(const Param* param);
+
+    long read(const Param* param);
+    bool write(const Param* param, long value);
+    void limits(const Param* param, long* min, long* max, long* step);
+    bool parse(const Param* param, const char* str, long* value);
+    template <unsigned char N>
+    void format(const Param* param, long value, TextBuffer<N>& text);
+    void print(Print* out, const Param* param);
+
+    static void wrapperCommand(const void* context, Print* out, const char* args);
+};
+
+// Checks the table order once, get() relies on it.
+void ParamRegistry::Init(const Param* table, unsigned char count)
+{
+    _table = table;
+    _count = count;
+    for (unsigned char i = 0; i < count; i++)
+    {
+        if (paramId(&table[i]) != i + 1)
+        {
+            Serial.print(F("Params: table out of order at "));
+            Serial.println(i);
+            _count = i;
+            break;
+        }
+    }
+    Serial.println(F("Params initialized"));
+}
+
+inline unsigned char ParamRegistry::count() { return _count; }
+
+inline const Param* ParamRegistry::at(unsigned char index) { return (index < _count) ? &_table[index] : nullptr; }
+
+// nullptr for menu entries without a setting (ID_NONE)
+inline const Param* ParamRegistry::get(MenuID id) { return (id != ID_NONE) ? at(id - 1) : nullptr; }
+
+const Param* ParamRegistry::find(const char* name)
+{
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        if (strcmp_P(name, _table[i].name) == 0) return &_table[i];
+    }
+    return nullptr;
+}
+
+const Param* ParamRegistry::byKey(unsigned char key)
+{
+    if (key == PARAM_NOT_STORED) return nullptr;
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        if (paramKey(&_table[i]) == key) return &_table[i];
+    }
+    return nullptr;
+}
+
+inline void ParamRegistry::addCommitCallback(const void* context, ParamCallback callback)
+{
+    _committed.add(context, callback);
+}
+
+// A finished edit (editor left, console set), as opposed to the steps written while turning the knob.
+// Only settings with a key are announced, the others are never stored.
+inline void ParamRegistry::commit(const Param* param)
+{
+    if (paramKey(param) != PARAM_NOT_STORED) _committed.notify(param);
+}
+
+long ParamRegistry::read(const Param* param)
+{
+    const void* context = paramContext(param);
+    const DataConfig* config = paramConfig(param);
+    switch (config->type)
+    {
+        case TYPE_UCHAR: return config->ptr.confUChar->callback(context, nullptr);
+        case TYPE_USHORT: return config->ptr.confUShort->callback(context, nullptr);
+        case TYPE_FLOAT: return config->ptr.confFloat->callback(context, nullptr);
+        case TYPE_BOOL: return config->ptr.confBool->callback(context, nullptr);
+        case TYPE_ENUM: return config->ptr.confEnum->callback(context, nullptr);
+    }
+    return 0;
+}
+
+// Returns false without touching the setting when value is outside its limits.
+bool ParamRegistry::write(const Param* param, long value)
+{
+    long min, max, step;
+    limits(param, &min, &max, &step);
+    if (value < min || value > max) return false;
+
+    const void* context = paramContext(param);
+    const DataConfig* config = paramConfig(param);
+    switch (config->type)
+    {
+        case TYPE_UCHAR:
+        {
+            unsigned char v = value;
+            config->ptr.confUChar->callback(context, &v);
+            break;
+        }
+        case TYPE_USHORT:
+        {
+            unsigned short v = value;
+            config->ptr.confUShort->callback(context, &v);
+            break;
+        }
+        case TYPE_FLOAT:
+        {
+            Centi v = value;
+            config->ptr.confFloat->callback(context, &v);
+            break;
+        }
+        case TYPE_BOOL:
+        {
+            bool v = value;
+            config->ptr.confBool->callback(context, &v);
+            break;
+        }
+        case TYPE_ENUM:
+        {
+            short v = value;
+            config->ptr.confEnum->callback(context, &v);
+            break;
+        }
+    }
+    return true;
+}
+
+void ParamRegistry::limits(const Param* param, long* min, long* max, long* step)
+{
+    const DataConfig* config = paramConfig(param);
+    *min = *max = 0;
+    *step = 1;
+    switch (config->type)
+    {
+        case TYPE_UCHAR:
+            *min = config->ptr.confUChar->minVal;
+            *max = config->ptr.confUChar->maxVal;
+            *step = config->ptr.confUChar->step;
+            break;
+        case TYPE_USHORT:
+            *min = config->ptr.confUShort->minVal;
+            *max = config->ptr.confUShort->maxVal;
+            *step = config->ptr.confUShort->step;
+            break;
+        case TYPE_FLOAT:
+            *min = config->ptr.confFloat->minVal;
+            *max = config->ptr.confFloat->maxVal;
+            *step = config->ptr.confFloat->step;
+            break;
+        case TYPE_BOOL:
+            *min = 0;
+            *max = 1;
+            *step = 1;
+            break;
+        case TYPE_ENUM:
+            *min = 0;
+            *max = config->ptr.confEnum->maxVal;
+            *step = 1;
+            break;
+    }
+}
+
+// Text to value, as typed on the console: "21.5", "30", "ON", "SUCHY" or an option index.
+bool ParamRegistry::parse(const Param* param, const char* str, long* value)
+{
+    const DataConfig* config = paramConfig(param);
+    switch (config->type)
+    {
+        case TYPE_FLOAT:
+        {
+            Centi v;
+            if (!parseCenti(str, &v)) return false;
+            *value = v;
+            return true;
+        }
+        case TYPE_BOOL:
+            if (strcmp_P(str, config->ptr.confBool->txtOn) == 0) str = "1";
+            else if (strcmp_P(str, config->ptr.confBool->txtOff) == 0) str = "0";
+            break;
+        case TYPE_ENUM:
+            for (unsigned char i = 0; i <= (unsigned char)config->ptr.confEnum->maxVal; i++)
+            {
+                if (strcmp_P(str, config->ptr.confEnum->options[i]) == 0)
+                {
+                    *value = i;
+                    return true;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    char* end;
+    *value = strtol(str, &end, 10);
+    return end != str && *end == '\0';
+}
+
+template <unsigned char N>
+void ParamRegistry::format(const Param* param, long value, TextBuffer<N>& text)
+{
+    const DataConfig* config = paramConfig(param);
+    switch (config->type)
+    {
+        case TYPE_UCHAR:
+            text.number(value).unit(config->ptr.confUChar->unit);
+            break;
+        case TYPE_USHORT:
+            text.number(value).unit(config->ptr.confUShort->unit);
+            break;
+        case TYPE_FLOAT:
+            text.centi(value, 1).unit(config->ptr.confFloat->unit);
+            break;
+        case TYPE_BOOL:
+            text.textP((value != 0) ? config->ptr.confBool->txtOn : config->ptr.confBool->txtOff);
+            break;
+        case TYPE_ENUM:
+            if (value >= 0 && value <= config->ptr.confEnum->maxVal) text.textP(config->ptr.confEnum->options[value]);
+            else text.put('?');
+            break;
+    }
+}
+
+// "name=value unit"
+void ParamRegistry::print(Print* out, const Param* param)
+{
+    TextBuffer<PARAM_VALUE_LENGTH> value;
+    format(param, read(param), value);
+    out->print(paramName(param));
+    out->print('=');
+    out->println(value.c_str());
+}
+
+// "param" lists every setting, "param <name>" shows one, "param <name> <value>" changes it
+void ParamRegistry::wrapperCommand(const void* context, Print* out, const char* args)
+{
+    ParamRegistry* obj = (ParamRegistry*)context;
+    if (args[0] == '\0')
+    {
+        for (unsigned char i = 0; i < obj->_count; i++) obj->print(out, &obj->_table[i]);
+        return;
+    }
+
+    // the name ends at a space or the end of the line, a longer one can not match any setting
+    const char* value = args;
+    while (*value != '\0' && *value != ' ') value++;
+    const Param* param = nullptr;
+    if (value - args < PARAM_NAME_LENGTH)
+    {
+        char name[PARAM_NAME_LENGTH];
+        memcpy(name, args, value - args);
+        name[value - args] = '\0';
+        param = obj->find(name);
+    }
+    while (*value == ' ') value++;
+    if (!param)
+    {
+        out->println(F("unknown parameter"));
+        return;
+    }
+    if (*value != '\0')
+    {
+        long v;
+        if (!obj->parse(param, value, &v)) out->println(F("bad value"));
+        else if (!obj->write(param, v)) out->println(F("out of range"));
+        else obj->commit(param);
+    }
+    obj->print(out, param);
+}
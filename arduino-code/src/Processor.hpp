@@ -4,26 +4,28 @@
 
 #include "SoilSensorState.hpp"
 #include "DataTypes.hpp"
+#include "HysteresisQuantizer.hpp"
 
 #include "DHTSensor.hpp"
 #include "SoilSensor.hpp"
 #include "WaterLevelSensor.hpp"
 #include "Light.hpp"
 #include "Relays.hpp"
+#include "EventQueue.hpp"
+
+const char PUMP_SETPOINT_STR[3][CONFIG_OPTION_LENGTH] PROGMEM = {"MOKRY", "WILGOTNY", "SUCHY"};
 
 class Processor
 {
 private:
-    const char* _pump_setpoints[3] = {"MOKRY", "WILGOTNY", "SUCHY"};
-
     //#pragma region Type Config
-    const ConfigFloat _temp_setpoint_cf = {wrapperTempSetpoint, -10, 50, 0.5, "C"};
-    const ConfigFloat _temp_hys_cf = {wrapperTempHys, 0, 20, 0.5, "C"};
-    const ConfigFloat _hum_setpoint_cf = {wrapperHumSetpoint, 0, 100, 1, "%"};
-    const ConfigFloat _hum_hys_cf = {wrapperHumHys, 0, 50, 1, "%"};
+    const ConfigFloat _temp_setpoint_cf = {wrapperTempSetpoint, CENTI(-10), CENTI(50), CENTI(0.5), "C"};
+    const ConfigFloat _temp_hys_cf = {wrapperTempHys, 0, CENTI(20), CENTI(0.5), "C"};
+    const ConfigFloat _hum_setpoint_cf = {wrapperHumSetpoint, 0, CENTI(100), CENTI(1), "%"};
+    const ConfigFloat _hum_hys_cf = {wrapperHumHys, 0, CENTI(50), CENTI(1), "%"};
 
     const ConfigUChar _pump_sensor_active_count_cf = {wrapperPumpSensorActiveCount, 1, 3, 1, ""};
-    const ConfigEnum _pump_setpoint_cf = {wrapperPumpSetpoint, _pump_setpoints, 3 - 1};
+    const ConfigEnum _pump_setpoint_cf = {wrapperPumpSetpoint, PUMP_SETPOINT_STR, 3 - 1};
     const ConfigUChar _pump_run_time_cf = {wrapperPumpRunTime, 1, 255, 1, "s"};
     const ConfigUChar _pump_run_interval_cf = {wrapperPumpRunInterval, 0, 255, 1, "s"};
 
@@ -33,10 +35,10 @@ private:
     const ConfigUShort _led_run_interval_cf = {wrapperLedRunInterval, 0, 1440, 5, "min"};
     //#pragma endregion
 
-    float _temp_setpoint = 24; //c
-    float _temp_hys = 2; //c
-    float _hum_setpoint = 55; //%
-    float _hum_hys = 5; //%
+    Centi _temp_setpoint = CENTI(24); //c
+    Centi _temp_hys = CENTI(2); //c
+    Centi _hum_setpoint = CENTI(55); //%
+    Centi _hum_hys = CENTI(5); //%
 
     unsigned char _pump_sensor_active_count = 2;
     SoilSensorState _pump_setpoint = SOIL_DRY;
@@ -54,27 +56,38 @@ private:
     WaterLevelSensor* _water = nullptr;
     Light* _light = nullptr;
     Relays* _relays = nullptr;
+    EventQueue* _events = nullptr;
 
     SoilSensorState _soil_state[3] = {UNINITIALIZED, UNINITIALIZED, UNINITIALIZED};
+    Centi _temp_in = CENTI_NAN;
+    Centi _hum_in = CENTI_NAN;
+    unsigned char _water_level = 0;
+    unsigned char _changed = 0; // bit per EventType received since the last evaluation
 
     bool _pump_active = false;
     unsigned long _pump_time = 0;
     unsigned long _pump_delay = 0;
 
     bool _led_active = false;
+    unsigned char _light_level = 1; // quantized: 0 dark, 1 bright
+    unsigned char _light_level_raw = 100; //%
     unsigned long _led_time = 0;
     unsigned long _led_delay = 0;
     
     void _checkSoil();
-    void _dhtInCahnged(const float* temp, const float* hum);
-    void _soilChanged(const unsigned char* id, const SoilSensorState* state);
+    void _dhtInCahnged(const Centi* temp, const Centi* hum);
     void _lightChanged(const unsigned char* level);
     void _waterChanged(const unsigned char* level);
+    void _event(const Event* event);
+    void _evaluate();
 
-    static void _wrapperDHTInCahnged(const void* context, const float* temp, const float* hum);
+    // sensor callbacks only queue the change, the work happens in _event()/_evaluate()
+    static void _wrapperDHTInCahnged(const void* context, const Centi* temp, const Centi* hum);
     static void _wrapperSoilChanged(const void* context, const unsigned char* id, const SoilSensorState* state);
     static void _wrapperLightChanged(const void* context, const unsigned char* level);
     static void _wrapperWaterChanged(const void* context, const unsigned char* level);
+    static void _wrapperEvent(const void* context, const Event* event);
+    static void _wrapperEventsDrained(const void* context);
 
 public:
     //#pragma region Data Config
@@ -96,16 +109,16 @@ public:
 
     Processor();
     void Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, SoilSensor* soil2, 
-    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays);
+    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays, EventQueue* events);
 
     void update();
 
     //#pragma region Settings Declaration
 
-    inline float tempSetpoint(const float* temp);
-    inline float tempHys(const float* temp);
-    inline float humSetpoint(const float* perc);
-    inline float humHys(const float* perc);
+    inline Centi tempSetpoint(const Centi* temp);
+    inline Centi tempHys(const Centi* temp);
+    inline Centi humSetpoint(const Centi* perc);
+    inline Centi humHys(const Centi* perc);
 
     inline unsigned char pumpSensorActiveCount(const unsigned char* count);
     inline short pumpSetpoint(const short* point);
@@ -117,10 +130,12 @@ public:
     inline unsigned short ledRunTime(const unsigned short* time);
     inline unsigned short ledRunInterval(const unsigned short* time);
 
-    static float wrapperTempSetpoint(const void* context, const float* temp);
-    static float wrapperTempHys(const void* context, const float* temp);
-    static float wrapperHumSetpoint(const void* context, const float* perc);
-    static float wrapperHumHys(const void* context, const float* perc);
+    static void wrapperUpdate(const void* context);
+
+    static Centi wrapperTempSetpoint(const void* context, const Centi* temp);
+    static Centi wrapperTempHys(const void* context, const Centi* temp);
+    static Centi wrapperHumSetpoint(const void* context, const Centi* perc);
+    static Centi wrapperHumHys(const void* context, const Centi* perc);
 
     static unsigned char wrapperPumpSensorActiveCount(const void* context, const unsigned char* count);
     static short wrapperPumpSetpoint(const void* context, const short* point);
@@ -149,9 +164,11 @@ void Processor::_checkSoil()
     }
 }
 
-void Processor::_dhtInCahnged(const float *temp, const float *hum)
+void Processor::_dhtInCahnged(const Centi *temp, const Centi *hum)
 {
-    bool enable;
+    if(!centiValid(*temp) || !centiValid(*hum)) return; // failed read, keep the outputs as they are
+
+    bool enable = _relays->heater(nullptr);
     if(_relays->heater(nullptr))
     {
         if(*temp > _temp_setpoint + _temp_hys) enable = false;
@@ -163,10 +180,11 @@ void Processor::_dhtInCahnged(const float *temp, const float *hum)
     _relays->heater(&enable);
     _light->rLED(&enable);
 
-    float tempOut = _dht_out->getLastData().first;
+    Centi tempOut = _dht_out->getLastData().temperature;
     short direction = _relays->actuator(nullptr);
 
     if(direction == UNKNOWN || direction == FINISHED) direction = CLOSE;
+    else if(!centiValid(tempOut)) direction = UNKNOWN;
     else if(direction == OPEN || direction == FINISHED_OPEN)
     {
         if((tempOut > _temp_setpoint + _temp_hys && *hum < _hum_setpoint + _hum_hys)
@@ -185,20 +203,11 @@ void Processor::_dhtInCahnged(const float *temp, const float *hum)
     _relays->actuator(&direction);
 }
 
-inline void Processor::_soilChanged(const unsigned char *id, const SoilSensorState *state)
-{
-    _soil_state[*id] = *state;
-    _checkSoil();
-    update();
-}
-
 inline void Processor::_lightChanged(const unsigned char *level)
 {
-    if(*level < _led_treshold - _led_hys)
-        _led_active = true;
-    else if(*level > _led_treshold + _led_hys)
-        _led_active = false;
-    update();
+    short threshold = _led_treshold;
+    _light_level = HysteresisQuantizer<1>::step(&threshold, _led_hys, _light_level, *level);
+    _led_active = _light_level == 0;
 }
 
 inline void Processor::_waterChanged(const unsigned char *level)
@@ -211,34 +220,81 @@ inline void Processor::_waterChanged(const unsigned char *level)
     _light->gLED(&enable);
 }
 
-void Processor::_wrapperDHTInCahnged(const void* context, const float* temp, const float* hum)
+// Keeps the latest value of every event, the decisions wait for _evaluate().
+void Processor::_event(const Event* event)
+{
+    switch (event->type)
+    {
+    case EVENT_DHT_IN:
+        _temp_in = event->value[0];
+        _hum_in = event->value[1];
+        break;
+    case EVENT_SOIL:
+        if (event->source < 3) _soil_state[event->source] = (SoilSensorState)event->value[0];
+        break;
+    case EVENT_LIGHT:
+        _light_level_raw = event->value[0];
+        break;
+    case EVENT_WATER:
+        _water_level = event->value[0];
+        break;
+    default:
+        return;
+    }
+    _changed |= 1 << event->type;
+}
+
+// One control evaluation per dispatch, however many events came in.
+void Processor::_evaluate()
+{
+    if (_changed & (1 << EVENT_DHT_IN)) _dhtInCahnged(&_temp_in, &_hum_in);
+    if (_changed & (1 << EVENT_SOIL)) _checkSoil();
+    if (_changed & (1 << EVENT_LIGHT)) _lightChanged(&_light_level_raw);
+    if (_changed & (1 << EVENT_WATER)) _waterChanged(&_water_level);
+    if (_changed & ((1 << EVENT_SOIL) | (1 << EVENT_LIGHT))) update();
+    _changed = 0;
+}
+
+void Processor::_wrapperDHTInCahnged(const void* context, const Centi* temp, const Centi* hum)
 {
     Processor* obj = (Processor*)context;
-    return obj->_dhtInCahnged(temp, hum);
+    obj->_events->post(EVENT_DHT_IN, 0, *temp, *hum);
 }
 
 void Processor::_wrapperSoilChanged(const void *context, const unsigned char *id, const SoilSensorState *state)
 {
     Processor* obj = (Processor*)context;
-    return obj->_soilChanged(id, state);
+    obj->_events->post(EVENT_SOIL, *id, *state);
 }
 
 void Processor::_wrapperLightChanged(const void *context, const unsigned char *level)
 {
     Processor* obj = (Processor*)context;
-    return obj->_lightChanged(level);
+    obj->_events->post(EVENT_LIGHT, 0, *level);
 }
 
 void Processor::_wrapperWaterChanged(const void *context, const unsigned char *level)
 {
     Processor* obj = (Processor*)context;
-    return obj->_waterChanged(level);
+    obj->_events->post(EVENT_WATER, 0, *level);
+}
+
+void Processor::_wrapperEvent(const void* context, const Event* event)
+{
+    Processor* obj = (Processor*)context;
+    obj->_event(event);
+}
+
+void Processor::_wrapperEventsDrained(const void* context)
+{
+    Processor* obj = (Processor*)context;
+    obj->_evaluate();
 }
 
 Processor::Processor() {}
 
 void Processor::Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, SoilSensor* soil2, 
-    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays)
+    SoilSensor* soil3, WaterLevelSensor* water, Light* light, Relays* relays, EventQueue* events)
 {
     _dht_in = dhtIn;
     _dht_out = dhtOut;
@@ -248,14 +304,17 @@ void Processor::Init(DHTSensor* dhtIn, DHTSensor* dhtOut, SoilSensor* soil1, Soi
     _water = water;
     _light = light;
     _relays = relays;
+    _events = events;
 
+    _events->addHandler(this, _wrapperEvent);
+    _events->addDrainedCallback(this, _wrapperEventsDrained);
     _dht_in->addCallback(this, _wrapperDHTInCahnged);
     _soil[0]->addCallback(this, _wrapperSoilChanged);
     _soil[1]->addCallback(this, _wrapperSoilChanged);
     _soil[2]->addCallback(this, _wrapperSoilChanged);
     _water->addCallback(this, _wrapperWaterChanged);
     _light->addCallback(this, _wrapperLightChanged);
-    Serial.println("Processor initialized");
+    Serial.println(F("Processor initialized"));
 }
 
 void Processor::update()
@@ -291,8 +350,9 @@ void Processor::update()
 
     if(!_led_active)
     {
-        if(_relays->led(nullptr) != check)
-            _relays->led(&check);
+        bool off = false; // not check, the pump branch may have left it true
+        if(_relays->led(nullptr) != off)
+            _relays->led(&off);
         if(_led_delay != 0)
         {
             _led_time = 0;
@@ -320,22 +380,22 @@ void Processor::update()
 
 //#pragma region settings
 
-inline float Processor::tempSetpoint(const float* temp) {
+inline Centi Processor::tempSetpoint(const Centi* temp) {
     if (temp) _temp_setpoint = *temp;
     return _temp_setpoint;
 }
 
-inline float Processor::tempHys(const float* temp) {
+inline Centi Processor::tempHys(const Centi* temp) {
     if (temp) _temp_hys = *temp;
     return _temp_hys;
 }
 
-inline float Processor::humSetpoint(const float* perc) {
+inline Centi Processor::humSetpoint(const Centi* perc) {
     if (perc) _hum_setpoint = *perc;
     return _hum_setpoint;
 }
 
-inline float Processor::humHys(const float* perc) {
+inline Centi Processor::humHys(const Centi* perc) {
     if (perc) _hum_hys = *perc;
     return _hum_hys;
 }
@@ -345,9 +405,12 @@ inline unsigned char Processor::pumpSensorActiveCount(const unsigned char* count
     return _pump_sensor_active_count;
 }
 
+// the setting is an index into PUMP_SETPOINT_STR, i.e. the wet, moist and dry soil states
 inline short Processor::pumpSetpoint(const short* point) {
-    if (point) _pump_setpoint = (SoilSensorState)*point;
-    return _pump_setpoint;
+    if (point && *point >= 0 && *point <= _pump_setpoint_cf.maxVal) _pump_setpoint = soilLevelStates[*point + 1];
+    for (short i = 0; i < 3; i++)
+        if (soilLevelStates[i + 1] == _pump_setpoint) return i;
+    return 0;
 }
 
 inline unsigned char Processor::pumpRunTime(const unsigned char* time) {
@@ -380,25 +443,31 @@ inline unsigned short Processor::ledRunInterval(const unsigned short* time) {
     return _led_run_interval;
 }
 
-float Processor::wrapperTempSetpoint(const void *context, const float *temp)
+void Processor::wrapperUpdate(const void *context)
+{
+    Processor* obj = (Processor*)context;
+    obj->update();
+}
+
+Centi Processor::wrapperTempSetpoint(const void *context, const Centi *temp)
 {
     Processor* obj = (Processor*)context;
     return obj->tempSetpoint(temp);
 }
 
-float Processor::wrapperTempHys(const void *context, const float *temp)
+Centi Processor::wrapperTempHys(const void *context, const Centi *temp)
 {
     Processor* obj = (Processor*)context;
     return obj->tempHys(temp);
 }
 
-float Processor::wrapperHumSetpoint(const void *context, const float *perc)
+Centi Processor::wrapperHumSetpoint(const void *context, const Centi *perc)
 {
     Processor* obj = (Processor*)context;
     return obj->humSetpoint(perc);
 }
 
-float Processor::wrapperHumHys(const void *context, const float *perc)
+Centi Processor::wrapperHumHys(const void *context, const Centi *perc)
 {
     Processor* obj = (Processor*)context;
     return obj->humHys(perc);
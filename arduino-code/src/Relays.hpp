@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 #include "DataTypes.hpp"
+#include "Observers.hpp"
+#include "FastPin.hpp"
 
 #define RELAY_ACTUATOR_PIN 46
 #define RELAY_DIRECTION_PIN 45
@@ -9,6 +11,21 @@
 #define RELAY_LED_PIN 43
 #define RELAY_HEATER_PIN 42
 #define RELAY_FAN_PIN 31
+#define RELAYS_OBSERVERS 1 // display
+
+// output channels, bit n of the shadow register is the pin level of channel n
+enum RelayChannel{
+    RELAY_CH_ACTUATOR,
+    RELAY_CH_DIRECTION,
+    RELAY_CH_PUMP,
+    RELAY_CH_LED,
+    RELAY_CH_HEATER,
+    RELAY_CH_FAN,
+    RELAY_CHANNELS
+};
+
+#define RELAYS_ALL ((1 << RELAY_CHANNELS) - 1)
+#define RELAYS_IDLE (RELAYS_ALL & ~(1 << RELAY_CH_FAN)) // relay boards are active low, the fan active high
 
 enum ActuatorDirection{
     UNKNOWN = -1,
@@ -21,16 +38,18 @@ enum ActuatorDirection{
 
 using RelaysCallback = void (*)(const void*, const ActuatorDirection*, const bool*, const bool*, const bool*);
 
-const char* MODE_STR[6] = {"NIEZNANY", "ZAMKNIJ", "OTWORZ", "ZAKONCZONO", "Z_ZAMKNIETE", "Z_OTWARTE"};
+#define MODE_STR_LENGTH 12 // "Z_ZAMKNIETE" + '\0'
+
+const char MODE_STR[6][MODE_STR_LENGTH] PROGMEM = {"NIEZNANY", "ZAMKNIJ", "OTWORZ", "ZAKONCZONO", "Z_ZAMKNIETE", "Z_OTWARTE"};
+const char ACTUATOR_MODE_STR[3][CONFIG_OPTION_LENGTH] PROGMEM = {"ZAMKNIJ", "OTWORZ", "STOP"};
 
 class Relays
 {
 private:
-    const char* _actuator_mode[3] = {"ZAMKNIJ", "OTWORZ", "STOP"};
-    const ConfigEnum _direction_cf = {wrapperActuator, _actuator_mode, FINISHED};
-    const ConfigBool _led_cf = {wrapperLED, "ON", "OFF"};
-    const ConfigBool _heater_cf = {wrapperHeater, "ON", "OFF"};
-    const ConfigBool _pump_cf = {wrapperPump, "ON", "OFF"};
+    const ConfigEnum _direction_cf = {wrapperActuator, ACTUATOR_MODE_STR, FINISHED};
+    const ConfigBool _led_cf = {wrapperLED, CONFIG_ON, CONFIG_OFF};
+    const ConfigBool _heater_cf = {wrapperHeater, CONFIG_ON, CONFIG_OFF};
+    const ConfigBool _pump_cf = {wrapperPump, CONFIG_ON, CONFIG_OFF};
     const ConfigUChar _realy_delay_cf = {wrapperRelayDelay, 25, 255, 1, "ms"};
     const ConfigUChar _relay_off_delay_cf = {wrapperRelayOffDelay, 1, 255, 1, "s"};
 
@@ -45,11 +64,22 @@ private:
     
     ActuatorDirection _actuator_state = UNKNOWN;
     ActuatorDirection _current_actuator_state = UNKNOWN;
-    std::vector<std::pair<const void*, RelaysCallback>> _callbacks;
+    Observers<RelaysCallback, RELAYS_OBSERVERS> _callbacks;
+
+    // The control code only changes _shadow, update() writes the difference to the pins once per tick.
+    unsigned char _shadow = RELAYS_IDLE; // wanted pin levels
+    unsigned char _output = RELAYS_IDLE; // levels on the pins
+    unsigned char _last_toggled = 0;     // channels switched by the last commit
+    unsigned short _toggles[RELAY_CHANNELS] = {0};
+    unsigned long _commits = 0;
     
     void _run_actuator(ActuatorDirection open);
     void _stop_actuator();
     void _callCallbacks();
+    void _level(RelayChannel channel, bool high);
+    bool _levelOf(RelayChannel channel);
+    static void _write(unsigned char levels, unsigned char channels);
+    void _commit();
     
 public:
     const DataConfig actuatorConfig = {TYPE_ENUM, {.confEnum = &_direction_cf}};
@@ -71,6 +101,10 @@ public:
     unsigned char relayDelay(const unsigned char* delay);
     unsigned char relayOffDelay(const unsigned char* delay);
     
+    void printStatus(Print* out);
+
+    static void wrapperUpdate(const void* context);
+    static void wrapperStatusCommand(const void* context, Print* out, const char* args);
     static short wrapperActuator(const void* context, const short* mode);
     static bool wrapperLED(const void* context, const bool* mode);
     static bool wrapperHeater(const void* context, const bool* mode);
@@ -85,15 +119,14 @@ inline void Relays::_run_actuator(ActuatorDirection mode)
     else
     {
         _actuator_state = mode;
-        _current_actuator_state = UNKNOWN;
-        update();
+        _current_actuator_state = UNKNOWN; // the next update() starts the sequence
     }
 }
 
 inline void Relays::_stop_actuator()
 {
-    digitalWrite(RELAY_ACTUATOR_PIN, !false);
-    digitalWrite(RELAY_DIRECTION_PIN, !false);
+    _level(RELAY_CH_ACTUATOR, !false);
+    _level(RELAY_CH_DIRECTION, !false);
     _delay = _realy_delay;
     _current_actuator_state = FINISHED;
     _toCall = true;
@@ -102,12 +135,9 @@ inline void Relays::_stop_actuator()
 void Relays::_callCallbacks()
 {
     _toCall = false;
-    for (const auto& callback : _callbacks)
-    {
-        callback.second(callback.first, &_actuator_state, &_led_state, &_heater_state, &_pump_state);
-    }
+    _callbacks.notify(&_actuator_state, &_led_state, &_heater_state, &_pump_state);
     /*Serial.print("Actuator state: ");
-    Serial.print(MODE_STR[_actuator_state + 1]);
+    Serial.print((const __FlashStringHelper*)MODE_STR[_actuator_state + 1]);
     Serial.print(", LED: ");
     Serial.print(_led_state);
     Serial.print(", Heater: ");
@@ -120,24 +150,19 @@ Relays::Relays() {}
 
 inline void Relays::Init()
 {
-    pinMode(RELAY_ACTUATOR_PIN, OUTPUT);
-    pinMode(RELAY_DIRECTION_PIN, OUTPUT);
-    pinMode(RELAY_PUMP_PIN, OUTPUT);
-    pinMode(RELAY_LED_PIN, OUTPUT);
-    pinMode(RELAY_HEATER_PIN, OUTPUT);
-    pinMode(RELAY_FAN_PIN, OUTPUT);
-    digitalWrite(RELAY_ACTUATOR_PIN, !false);
-    digitalWrite(RELAY_DIRECTION_PIN, !false);
-    digitalWrite(RELAY_PUMP_PIN, !false);
-    digitalWrite(RELAY_LED_PIN, !false);
-    digitalWrite(RELAY_HEATER_PIN, !false);
-    digitalWrite(RELAY_FAN_PIN, false);
-    Serial.println("Relays initialized");
+    _write(_output, RELAYS_ALL); // levels first, so no relay clicks when the pins turn into outputs
+    FastPin<RELAY_ACTUATOR_PIN>::output();
+    FastPin<RELAY_DIRECTION_PIN>::output();
+    FastPin<RELAY_PUMP_PIN>::output();
+    FastPin<RELAY_LED_PIN>::output();
+    FastPin<RELAY_HEATER_PIN>::output();
+    FastPin<RELAY_FAN_PIN>::output();
+    Serial.println(F("Relays initialized"));
 }
 
 void Relays::update()
 {
-    digitalWrite(RELAY_FAN_PIN, (_actuator_state == OPEN || _actuator_state == FINISHED_OPEN));
+    _level(RELAY_CH_FAN, _actuator_state == OPEN || _actuator_state == FINISHED_OPEN);
 
     if(_actuator_state != _current_actuator_state && millis() - _last_read >= _delay)
     {
@@ -147,23 +172,23 @@ void Relays::update()
             _actuator_state = (_actuator_state == OPEN) ? FINISHED_OPEN : FINISHED_CLOSE;
             _toCall = true;
         }
-        else if(!digitalRead(RELAY_ACTUATOR_PIN)) //is motor running
+        else if(!_levelOf(RELAY_CH_ACTUATOR)) //is motor running
         {
-            digitalWrite(RELAY_ACTUATOR_PIN, !false);
+            _level(RELAY_CH_ACTUATOR, !false);
             _delay = _realy_delay;
             _toCall = true;
         }
         else
         {
-            if((!digitalRead(RELAY_DIRECTION_PIN)) !=  _actuator_state)
+            if((!_levelOf(RELAY_CH_DIRECTION)) !=  _actuator_state)
             {
-                digitalWrite(RELAY_DIRECTION_PIN,  !_actuator_state);
+                _level(RELAY_CH_DIRECTION, !_actuator_state);
                 _delay = _realy_delay;
                 _toCall = true;
             }
             else
             {
-                digitalWrite(RELAY_ACTUATOR_PIN, !true);
+                _level(RELAY_CH_ACTUATOR, !true);
                 _delay = _relay_off_delay * 60 * 1000;
                 _current_actuator_state = _actuator_state;
                 _toCall = true;
@@ -171,12 +196,49 @@ void Relays::update()
         }
     }
     else if (_delay != 0 && millis() - _last_read >= _delay) _stop_actuator();
+    _commit();
+}
+
+inline void Relays::_level(RelayChannel channel, bool high)
+{
+    if(high) _shadow |= 1 << channel;
+    else _shadow &= ~(1 << channel);
+}
+
+inline bool Relays::_levelOf(RelayChannel channel) { return _shadow & (1 << channel); }
+
+// One port write per port: the relays share PORTL, the fan is on PORTC.
+void Relays::_write(unsigned char levels, unsigned char channels)
+{
+    FastPinBatch batch;
+    if(channels & (1 << RELAY_CH_ACTUATOR)) batch.write<RELAY_ACTUATOR_PIN>(levels & (1 << RELAY_CH_ACTUATOR));
+    if(channels & (1 << RELAY_CH_DIRECTION)) batch.write<RELAY_DIRECTION_PIN>(levels & (1 << RELAY_CH_DIRECTION));
+    if(channels & (1 << RELAY_CH_PUMP)) batch.write<RELAY_PUMP_PIN>(levels & (1 << RELAY_CH_PUMP));
+    if(channels & (1 << RELAY_CH_LED)) batch.write<RELAY_LED_PIN>(levels & (1 << RELAY_CH_LED));
+    if(channels & (1 << RELAY_CH_HEATER)) batch.write<RELAY_HEATER_PIN>(levels & (1 << RELAY_CH_HEATER));
+    if(channels & (1 << RELAY_CH_FAN)) batch.write<RELAY_FAN_PIN>(levels & (1 << RELAY_CH_FAN));
+    batch.commit();
+}
+
+// Writes what changed since the last tick and tells the observers once about the final state.
+void Relays::_commit()
+{
+    unsigned char changed = _shadow ^ _output;
+    if(changed)
+    {
+        _write(_shadow, changed);
+        _output = _shadow;
+        _last_toggled = changed;
+        _commits++;
+        for (unsigned char i = 0; i < RELAY_CHANNELS; i++)
+            if((changed & (1 << i)) && _toggles[i] != 0xFFFF) _toggles[i]++;
+    }
     if(_toCall) _callCallbacks();
 }
 
 void Relays::addCallback(const void *context, RelaysCallback callback)
 {
-    _callbacks.push_back(std::make_pair(context, callback));
+    _callbacks.add(context, callback);
 }
 
 inline short Relays::actuator(const short* mode)
@@ -194,7 +256,7 @@ inline bool Relays::led(const bool* check)
 {
     if(check) {
         if(_led_state != *check) {
-            digitalWrite(RELAY_LED_PIN, !*check);
+            _level(RELAY_CH_LED, !*check);
             _led_state = *check;
             _toCall = true;
         }
@@ -206,7 +268,7 @@ inline bool Relays::heater(const bool* check)
 {
     if(check)
         if(_heater_state != *check){
-            digitalWrite(RELAY_HEATER_PIN, !*check);
+            _level(RELAY_CH_HEATER, !*check);
             _heater_state = *check;
             _toCall = true;
         }
@@ -218,7 +280,7 @@ inline bool Relays::pump(const bool* check)
 {
     if (check)
         if(_pump_state != *check){
-            digitalWrite(RELAY_PUMP_PIN, !*check);
+            _level(RELAY_CH_PUMP, !*check);
             _pump_state = *check;
             _toCall = true;
         }
@@ -239,10 +301,45 @@ inline unsigned char Relays::relayOffDelay(const unsigned char *delay)
 }
 
 
+void Relays::printStatus(Print* out)
+{
+    static const char names[RELAY_CHANNELS] = {'A', 'D', 'P', 'L', 'H', 'F'};
+    out->print(F("pins="));
+    for (unsigned char i = 0; i < RELAY_CHANNELS; i++) out->print((_output & (1 << i)) ? '1' : '0');
+    out->print(F(" commits="));
+    out->print(_commits);
+    out->print(F(" toggles"));
+    for (unsigned char i = 0; i < RELAY_CHANNELS; i++)
+    {
+        out->print(' ');
+        out->print(names[i]);
+        out->print('=');
+        out->print(_toggles[i]);
+        if(_last_toggled & (1 << i)) out->print('*');
+    }
+    out->println();
+}
+
+void Relays::wrapperUpdate(const void* context)
+{
+    Relays* obj = (Relays*)context;
+    obj->update();
+}
+
+// "relays": pin levels (actuator, direction, pump, led, heater, fan), commits, toggles per channel, * = last commit
+void Relays::wrapperStatusCommand(const void* context, Print* out, const char* args)
+{
+    (void)args;
+    Relays* obj = (Relays*)context;
+    obj->printStatus(out);
+}
+
 short Relays::wrapperActuator(const void* context, const short *mode )
 {
     Relays* obj = (Relays*)context;
-    return obj->actuator(mode);
+    short state = obj->actuator(mode);
+    if (state > FINISHED) state = FINISHED; // the menu only knows ZAMKNIJ/OTWORZ/STOP
+    return state;
 }
 
 bool Relays::wrapperLED(const void *context, const bool *check)
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "TaskStats.hpp"
+
+// Every slot carries a TaskStats histogram, so the application sizes the table to its tasks.
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 20
+#endif
+
+static_assert(SCHEDULER_MAX_TASKS <= 127, "task ids are signed char");
+
+using TaskCallback = void (*)(const void*);
+
+// Called by Scheduler::run() when no task is due yet. The default does nothing,
+// a platform may override it (e.g. to sleep or to fast-forward a simulated clock).
+void schedulerIdle(unsigned long deadline) __attribute__((weak));
+void schedulerIdle(unsigned long deadline) { (void)deadline; }
+
+class Scheduler
+{
+private:
+    struct Task
+    {
+        const __FlashStringHelper* name;
+        const void* context;
+        TaskCallback callback;
+        unsigned long period;   //ms
+        unsigned long deadline; //ms
+        unsigned long max_late; //ms
+        TaskStats stats;
+    };
+
+    Task _tasks[SCHEDULER_MAX_TASKS];
+    unsigned char _heap[SCHEDULER_MAX_TASKS]; // task indexes, min-heap ordered by deadline
+    unsigned char _count = 0;
+    unsigned long _next = 0; // deadline of the heap top
+
+    static bool _before(unsigned long a, unsigned long b);
+    bool _less(unsigned char a, unsigned char b);
+    void _siftUp(unsigned char pos);
+    void _siftDown(unsigned char pos);
+
+public:
+    Scheduler();
+    signed char addTask(const __FlashStringHelper* name, const void* context, TaskCallback callback, unsigned long period, unsigned long offset = 0);
+    void run();
+
+    unsigned char taskCount();
+    unsigned long nextDeadline();
+    unsigned long maxLateness(unsigned char id);
+    void printStats(Print* out);
+    void resetStats();
+
+    static void wrapperStatsCommand(const void* context, Print* out, const char* args);
+};
+
+// wrap-safe "a is earlier than b" for millis() timestamps
+inline bool Scheduler::_before(unsigned long a, unsigned long b) { return (long)(a - b) < 0; }
+
+inline bool Scheduler::_less(unsigned char a, unsigned char b)
+{
+    return _before(_tasks[_heap[a]].deadline, _tasks[_heap[b]].deadline);
+}
+
+void Scheduler::_siftUp(unsigned char pos)
+{
+    while (pos > 0)
+    {
+        unsigned char parent = (pos - 1) / 2;
+        if (!_less(pos, parent)) break;
+        unsigned char tmp = _heap[pos];
+        _heap[pos] = _heap[parent];
+        _heap[parent] = tmp;
+        pos = parent;
+    }
+}
+
+void Scheduler::_siftDown(unsigned char pos)
+{
+    while (true)
+    {
+        unsigned char smallest = pos;
+        unsigned char left = 2 * pos + 1;
+        unsigned char right = left + 1;
+        if (left < _count && _less(left, smallest)) smallest = left;
+        if (right < _count && _less(right, smallest)) smallest = right;
+        if (smallest == pos) break;
+        unsigned char tmp = _heap[pos];
+        _heap[pos] = _heap[smallest];
+        _heap[smallest] = tmp;
+        pos = smallest;
+    }
+}
+
+Scheduler::Scheduler() {}
+
+// Registers a periodic task. The first run happens `offset` ms from now, which lets
+// tasks with equal periods be spread out. Returns task id or -1 if the table is full.
+signed char Scheduler::addTask(const __FlashStringHelper* name, const void* context, TaskCallback callback, unsigned long period, unsigned long offset)
+{
+    if (_count >= SCHEDULER_MAX_TASKS)
+    {
+        Serial.println(F("Scheduler: task table full"));
+        return -1;
+    }
+    unsigned char id = _count;
+    Task& task = _tasks[id];
+    task.name = name;
+    task.context = context;
+    task.callback = callback;
+    task.period = period;
+    task.deadline = millis() + offset;
+    task.max_late = 0;
+    task.stats.reset();
+    _heap[_count] = id;
+    _count++;
+    _siftUp(_count - 1);
+    _next = _tasks[_heap[0]].deadline;
+    return id;
+}
+
+void Scheduler::run()
+{
+    unsigned long now = millis();
+    if (_count == 0 || _before(now, _next))
+    {
+        schedulerIdle(_next);
+        return;
+    }
+
+    // every task runs at most once per pass, so a zero period cannot starve the others
+    for (unsigned char n = 0; n < _count && !_before(now, _next); n++)
+    {
+        Task& task = _tasks[_heap[0]];
+        unsigned long late = now - task.deadline;
+        if (late > task.max_late) task.max_late = late;
+
+        unsigned long start = micros();
+        task.callback(task.context);
+        task.stats.record(micros() - start);
+
+        now = millis();
+        task.deadline += task.period;
+        if (_before(task.deadline, now)) task.deadline = now + task.period; // overran, skip missed runs
+        _siftDown(0);
+        _next = _tasks[_heap[0]].deadline;
+    }
+}
+
+inline unsigned char Scheduler::taskCount() { return _count; }
+
+inline unsigned long Scheduler::nextDeadline() { return _next; }
+
+inline unsigned long Scheduler::maxLateness(unsigned char id) { return (id < _count) ? _tasks[id].max_late : 0; }
+
+void Scheduler::printStats(Print* out)
+{
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        _tasks[i].stats.print(out, _tasks[i].name);
+        out->print(F(" late="));
+        out->print(_tasks[i].max_late);
+        out->println(F("ms"));
+    }
+}
+
+void Scheduler::resetStats()
+{
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        _tasks[i].max_late = 0;
+        _tasks[i].stats.reset();
+    }
+}
+
+// "stats" dumps the per task timing, "stats reset" starts a new measurement window
+void Scheduler::wrapperStatsCommand(const void* context, Print* out, const char* args)
+{
+    Scheduler* obj = (Scheduler*)context;
+    if (strcmp_P(args, PSTR("reset")) == 0)
+    {
+        obj->resetStats();
+        out->println(F("stats reset"));
+    }
+    else obj->printStats(out);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define CONSOLE_MAX_COMMANDS 12
+#define CONSOLE_LINE_LENGTH 48
+
+// args points at the text after the command name (empty string if none)
+using ConsoleCallback = void (*)(const void*, Print*, const char*);
+
+// Line based diagnostics console on Serial, e.g. "stats" or "stats reset" followed by a newline.
+class SerialConsole
+{
+private:
+    struct Command
+    {
+        const __FlashStringHelper* name;
+        const void* context;
+        ConsoleCallback callback;
+    };
+
+    const char* _version;
+    Stream* _stream = nullptr;
+    char _line[CONSOLE_LINE_LENGTH + 1];
+    unsigned char _len = 0;
+    bool _overflow = false;
+    Command _commands[CONSOLE_MAX_COMMANDS];
+    unsigned char _count = 0;
+
+    void _dispatch();
+    void _printHelp();
+
+public:
+    SerialConsole(const char* version);
+    void Init(Stream* stream);
+    bool addCommand(const __FlashStringHelper* name, const void* context, ConsoleCallback callback);
+    void update();
+
+    static void wrapperUpdate(const void* context);
+};
+
+SerialConsole::SerialConsole(const char* version) : _version(version) {}
+
+inline void SerialConsole::Init(Stream* stream)
+{
+    _stream = stream;
+    Serial.println(F("Serial console initialized"));
+}
+
+bool SerialConsole::addCommand(const __FlashStringHelper* name, const void* context, ConsoleCallback callback)
+{
+    if (_count >= CONSOLE_MAX_COMMANDS)
+    {
+        Serial.println(F("SerialConsole: command table full"));
+        return false;
+    }
+    _commands[_count++] = {name, context, callback};
+    return true;
+}
+
+void SerialConsole::_printHelp()
+{
+    _stream->print(F("commands: help"));
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        _stream->print(' ');
+        _stream->print(_commands[i].name);
+    }
+    _stream->println();
+}
+
+void SerialConsole::_dispatch()
+{
+    char* args = _line;
+    while (*args && *args != ' ') args++;
+    if (*args) *args++ = '\0';
+    while (*args == ' ') args++;
+    if (_line[0] == '\0') return;
+
+    // every answer starts with the firmware version and uptime so dumps can be compared later
+    _stream->print(F("# fw "));
+    _stream->print(_version);
+    _stream->print(F(" t="));
+    _stream->print(millis());
+    _stream->println(F("ms"));
+
+    for (unsigned char i = 0; i < _count; i++)
+    {
+        if (strcmp_P(_line, (PGM_P)_commands[i].name) == 0)
+        {
+            _commands[i].callback(_commands[i].context, _stream, args);
+            return;
+        }
+    }
+    _printHelp();
+}
+
+void SerialConsole::update()
+{
+    if (!_stream) return;
+    while (_stream->available() > 0)
+    {
+        char c = _stream->read();
+        if (c == '\r') continue;
+        if (c == '\n')
+        {
+            _line[_len] = '\0';
+            if (_overflow) _stream->println(F("line too long"));
+            else _dispatch();
+            _len = 0;
+            _overflow = false;
+        }
+        else if (_len < CONSOLE_LINE_LENGTH) _line[_len++] = c;
+        else _overflow = true;
+    }
+}
+
+void SerialConsole::wrapperUpdate(const void* context)
+{
+    SerialConsole* obj = (SerialConsole*)context;
+    obj->update();
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "EepromLayout.hpp"
+#include "Params.hpp"
+
+#define SETTINGS_SCHEMA 1         // bump when the record layout changes, older records are then ignored
+#define SETTINGS_SLOT_SIZE 160    // bytes, one record per slot, room for 51 entries
+#define SETTINGS_SLOTS (EEPROM_SETTINGS_SIZE / SETTINGS_SLOT_SIZE) // 19 on the Mega
+#define SETTINGS_HEADER 4         // schema, sequence (2), entry count
+#define SETTINGS_ENTRY 3          // key, value (2)
+#define SETTINGS_MAX_ENTRIES ((SETTINGS_SLOT_SIZE - SETTINGS_HEADER - 2) / SETTINGS_ENTRY)
+#define SETTINGS_SAVE_DELAY 5000  //ms after the last change, edits in a row end up in one record
+
+static_assert(SETTINGS_SLOTS <= 32, "slot bitmask in load() is 32 bits");
+
+// Every setting with a key in the ParamRegistry, kept in EEPROM.
+// Each save writes a complete record (header, key/value entries, CRC-16) into the next slot, so the
+// writes rotate over the settings part of the EEPROM and an interrupted save leaves the previous record intact.
+// At boot the newest record with a good CRC and schema wins; entries are matched by key, so
+// settings added or removed later keep the rest of the record usable.
+// Saving never blocks: a commit only starts the SETTINGS_SAVE_DELAY countdown, then update()
+// writes one byte per run whenever the EEPROM is ready (~3.4 ms per byte on the AVR).
+class SettingsStore
+{
+private:
+    ParamRegistry* _params = nullptr;
+    unsigned char _record[SETTINGS_SLOT_SIZE];
+    unsigned char _length = 0;   // bytes of _record being written
+    unsigned char _written = 0;
+    unsigned char _slot = 0;     // newest good record, valid when _stored
+    unsigned char _target = 0;   // slot being written
+    unsigned short _sequence = 0;
+    bool _stored = false;
+    bool _pending = false;
+    bool _retry = false;         // the last write failed, the next one goes to the slot after _target
+    unsigned long _last_commit = 0;
+    unsigned short _saves = 0;
+    unsigned short _unchanged = 0;
+    unsigned short _failed = 0;
+
+    static unsigned char* _address(unsigned char slot, unsigned char offset);
+    static unsigned short _crc(const unsigned char* data, unsigned char length);
+    static bool _newer(unsigned short a, unsigned short b);
+    bool _readSlot(unsigned char slot, unsigned char* length);
+    unsigned char _build(unsigned short sequence);
+    bool _sameAsStored(unsigned char length);
+    void _apply(unsigned char length);
+    void _finishWrite();
+    void _committed(const Param* param);
+    static void _wrapperCommitted(const void* context, const Param* param);
+
+public:
+    void Init(ParamRegistry* params);
+    void load();
+    void save();
+    void update();
+    void printStatus(Print* out);
+    void resetStats();
+
+    static void wrapperUpdate(const void* context);
+    static void wrapperCommand(const void* context, Print* out, const char* args);
+};
+
+void SettingsStore::Init(ParamRegistry* params)
+{
+    _params = params;
+    _params->addCommitCallback(this, _wrapperCommitted);
+    load();
+    Serial.println(F("Settings store initialized"));
+}
+
+inline unsigned char* SettingsStore::_address(unsigned char slot, unsigned char offset)
+{
+    return (unsigned char*)(uintptr_t)((unsigned short)slot * SETTINGS_SLOT_SIZE + offset);
+}
+
+unsigned short SettingsStore::_crc(const unsigned char* data, unsigned char length)
+{
+    unsigned short crc = 0xFFFF;
+    for (unsigned char i = 0; i < length; i++) crc = _crc_ccitt_update(crc, data[i]);
+    return crc;
+}
+
+// sequence numbers wrap, only the distance counts
+inline bool SettingsStore::_newer(unsigned short a, unsigned short b) { return (short)(a - b) > 0; }
+
+// Reads the record of slot into _record, false unless schema and CRC check out.
+bool SettingsStore::_readSlot(unsigned char slot, unsigned char* length)
+{
+    eeprom_read_block(_record, _address(slot, 0), SETTINGS_HEADER);
+    if (_record[0] != SETTINGS_SCHEMA || _record[3] > SETTINGS_MAX_ENTRIES) return false;
+    unsigned char len = SETTINGS_HEADER + _record[3] * SETTINGS_ENTRY;
+    eeprom_read_block(_record + SETTINGS_HEADER, _address(slot, SETTINGS_HEADER), len + 2 - SETTINGS_HEADER);
+    unsigned short crc = _record[len] | (_record[len + 1] << 8);
+    if (crc != _crc(_record, len)) return false;
+    *length = len;
+    return true;
+}
+
+// One pass over the slot headers picks the newest record, only that one is CRC checked
+// (and the next newest if it fails), then its values go through the registry.
+void SettingsStore::load()
+{
+    unsigned long rejected = 0;
+    while (true)
+    {
+        bool found = false;
+        unsigned char best = 0;
+        unsigned short bestSequence = 0;
+        for (unsigned char slot = 0; slot < SETTINGS_SLOTS; slot++)
+        {
+            if (rejected & (1UL << slot)) continue;
+            if (eeprom_read_byte(_address(slot, 0)) != SETTINGS_SCHEMA) continue;
+            unsigned short sequence = eeprom_read_byte(_address(slot, 1)) | (eeprom_read_byte(_address(slot, 2)) << 8);
+            if (!found || _newer(sequence, bestSequence))
+            {
+                found = true;
+                best = slot;
+                bestSequence = sequence;
+            }
+        }
+        if (!found)
+        {
+            Serial.println(F("Settings: no saved record, using defaults"));
+            return;
+        }
+
+        unsigned char length;
+        if (_readSlot(best, &length))
+        {
+            _slot = best;
+            _sequence = bestSequence;
+            _stored = true;
+            _apply(length);
+            return;
+        }
+        rejected |= 1UL << best;
+        Serial.print(F("Settings: bad record in slot "));
+        Serial.println(best);
+    }
+}
+
+void SettingsStore::_apply(unsigned char length)
+{
+    unsigned char loaded = 0;
+    for (unsigned char i = SETTINGS_HEADER; i < length; i += SETTINGS_ENTRY)
+    {
+        const Param* param = _params->byKey(_record[i]);
+        if (!param) continue; // setting removed since the save
+        unsigned short raw = _record[i + 1] | (_record[i + 2] << 8);
+        long value = (paramConfig(param)->type == TYPE_FLOAT) ? (long)(short)raw : (long)raw;
+        if (_params->write(param, value)) loaded++;
+    }
+    Serial.print(F("Settings: loaded "));
+    Serial.print(loaded);
+    Serial.print(F(" from slot "));
+    Serial.println(_slot);
+}
+
+// Current values of every stored setting, as the record that would be written next.
+unsigned char SettingsStore::_build(unsigned short sequence)
+{
+    unsigned char len = SETTINGS_HEADER;
+    for (unsigned char i = 0; i < _params->count(); i++)
+    {
+        const Param* param = _params->at(i);
+        unsigned char key = paramKey(param);
+        if (key == PARAM_NOT_STORED) continue;
+        if (len + SETTINGS_ENTRY + 2 > SETTINGS_SLOT_SIZE)
+        {
+            Serial.println(F("Settings: record full"));
+            break;
+        }
+        unsigned short raw = (unsigned short)_params->read(param);
+        _record[len++] = key;
+        _record[len++] = raw & 0xFF;
+        _record[len++] = raw >> 8;
+    }
+    _record[0] = SETTINGS_SCHEMA;
+    _record[1] = sequence & 0xFF;
+    _record[2] = sequence >> 8;
+    _record[3] = (len - SETTINGS_HEADER) / SETTINGS_ENTRY;
+    unsigned short crc = _crc(_record, len);
+    _record[len++] = crc & 0xFF;
+    _record[len++] = crc >> 8;
+    return len;
+}
+
+// Entries equal to the newest record, the sequence number and CRC aside
+bool SettingsStore::_sameAsStored(unsigned char length)
+{
+    if (!_stored || eeprom_read_byte(_address(_slot, 3)) != _record[3]) return false;
+    for (unsigned char i = SETTINGS_HEADER; i < length - 2; i++)
+    {
+        if (eeprom_read_byte(_address(_slot, i)) != _record[i]) return false;
+    }
+    return true;
+}
+
+// Save right away instead of after SETTINGS_SAVE_DELAY
+void SettingsStore::save()
+{
+    _pending = true;
+    _last_commit = millis() - SETTINGS_SAVE_DELAY;
+}
+
+void SettingsStore::update()
+{
+    if (_written < _length)
+    {
+        if (!eeprom_is_ready()) return;
+        eeprom_update_byte(_address(_target, _written), _record[_written]);
+        if (++_written == _length) _finishWrite();
+        return;
+    }
+    if (!_pending || millis() - _last_commit < SETTINGS_SAVE_DELAY) return;
+
+    _pending = false;
+    unsigned char length = _build(_sequence + 1);
+    if (_sameAsStored(length))
+    {
+        _unchanged++;
+        return;
+    }
+    if (_retry)
+    {
+        // past the slot that failed, never onto the newest good record
+        _target = (_target + 1) % SETTINGS_SLOTS;
+        if (_stored && _target == _slot) _target = (_target + 1) % SETTINGS_SLOTS;
+    }
+    else _target = _stored ? (_slot + 1) % SETTINGS_SLOTS : 0;
+    _length = length;
+    _written = 0;
+}
+
+// The record only counts once it reads back as written, otherwise it is written again into the
+// next slot after SETTINGS_SAVE_DELAY.
+void SettingsStore::_finishWrite()
+{
+    unsigned char length;
+    unsigned short sequence = _record[1] | (_record[2] << 8);
+    unsigned char written = _length;
+    _length = _written = 0;
+    if (!_readSlot(_target, &length) || length + 2 != written)
+    {
+        _failed++;
+        Serial.print(F("Settings: write failed in slot "));
+        Serial.println(_target);
+        _retry = true;
+        _pending = true;
+        _last_commit = millis();
+        return;
+    }
+    _retry = false;
+    _slot = _target;
+    _sequence = sequence;
+    _stored = true;
+    _saves++;
+}
+
+inline void SettingsStore::_committed(const Param* param)
+{
+    (void)param;
+    _pending = true;
+    _last_commit = millis();
+}
+
+void SettingsStore::printStatus(Print* out)
+{
+    out->print(F("slot="));
+    if (_stored) out->print(_slot);
+    else out->print('-');
+    out->print(F(" seq="));
+    out->print(_sequence);
+    out->print(F(" saves="));
+    out->print(_saves);
+    out->print(F(" unchanged="));
+    out->print(_unchanged);
+    out->print(F(" failed="));
+    out->print(_failed);
+    out->print(F(" pending="));
+    out->print(_pending);
+    out->print(F(" writing="));
+    out->print(_written);
+    out->print('/');
+    out->println(_length);
+}
+
+inline void SettingsStore::resetStats()
+{
+    _saves = _unchanged = _failed = 0;
+}
+
+void SettingsStore::wrapperUpdate(const void* context)
+{
+    SettingsStore* obj = (SettingsStore*)context;
+    obj->update();
+}
+
+// "settings" shows the store, "settings save" writes now, "settings reset" clears the counters
+void SettingsStore::wrapperCommand(const void* context, Print* out, const char* args)
+{
+    SettingsStore* obj = (SettingsStore*)context;
+    if (strcmp_P(args, PSTR("save")) == 0) obj->save();
+    else if (strcmp_P(args, PSTR("reset")) == 0) obj->resetStats();
+    obj->printStatus(out);
+}
+
+void SettingsStore::_wrapperCommitted(const void* context, const Param* param)
+{
+    SettingsStore* obj = (SettingsStore*)context;
+    obj->_committed(param);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "DataTypes.hpp"
+#include "AdcScanner.hpp"
+#include "SoilSensor.hpp"
+
+#define SOIL_SAMPLER_SENSORS 3
+#define SOIL_SAMPLE_TIMEOUT 200 //ms, fresh ADC blocks normally arrive within ~10 ms
+
+enum SoilSamplerState
+{
+    SAMPLER_IDLE,
+    SAMPLER_SETTLING,
+    SAMPLER_SAMPLING
+};
+
+// Drives the probe supply shared by all soil sensors (SOIL_SENSOR_EN_PIN). When any sensor is
+// due the rail is switched on once, after the settle time fresh ADC blocks of all probes are
+// collected in one burst and handed to every sensor that is due, then the rail goes off again.
+// Each sensor keeps its own read delay; with equal delays they end up in the same power cycle.
+class SoilSampler
+{
+private:
+    const ConfigUShort _settle_cf = {wrapperSettleTime, 10, 5000, 10, "ms"};
+
+    unsigned char _enPin;
+    bool _enActive;
+    SoilSensor* _sensors[SOIL_SAMPLER_SENSORS] = {nullptr, nullptr, nullptr};
+    AdcScanner* _adc = nullptr;
+
+    SoilSamplerState _state = SAMPLER_IDLE;
+    unsigned long _since = 0; //ms
+    unsigned short _settle_time = 300; //ms
+    unsigned long _cycles = 0;
+    unsigned long _errors = 0;
+
+    void _power(bool on);
+    bool _anyDue();
+
+public:
+    const DataConfig settleConfig = {TYPE_USHORT, {.confUShort = &_settle_cf}};
+
+    SoilSampler(unsigned char enPin, bool enActive);
+    void Init(AdcScanner* adc, SoilSensor* soil1, SoilSensor* soil2, SoilSensor* soil3);
+    void update();
+
+    unsigned short settleTime(const unsigned short* time);
+    unsigned long cycles();
+
+    static void wrapperUpdate(const void* context);
+    static unsigned short wrapperSettleTime(const void* context, const unsigned short* time);
+};
+
+SoilSampler::SoilSampler(unsigned char enPin, bool enActive) : _enPin(enPin), _enActive(enActive) {}
+
+inline void SoilSampler::_power(bool on) { digitalWrite(_enPin, on ? _enActive : !_enActive); }
+
+bool SoilSampler::_anyDue()
+{
+    for (unsigned char i = 0; i < SOIL_SAMPLER_SENSORS; i++)
+        if (_sensors[i]->due()) return true;
+    return false;
+}
+
+void SoilSampler::Init(AdcScanner* adc, SoilSensor* soil1, SoilSensor* soil2, SoilSensor* soil3)
+{
+    _adc = adc;
+    _sensors[0] = soil1;
+    _sensors[1] = soil2;
+    _sensors[2] = soil3;
+    pinMode(_enPin, OUTPUT);
+    _power(false);
+    Serial.println(F("Soil sampler initialized"));
+}
+
+void SoilSampler::update()
+{
+    switch (_state)
+    {
+    case SAMPLER_IDLE:
+        if (!_anyDue()) return;
+        _power(true);
+        _since = millis();
+        _state = SAMPLER_SETTLING;
+        break;
+
+    case SAMPLER_SETTLING:
+        if (millis() - _since < _settle_time) return;
+        // drop what the scanner averaged while the probes were unpowered or settling
+        for (unsigned char i = 0; i < SOIL_SAMPLER_SENSORS; i++) _adc->restart(_sensors[i]->pin());
+        _since = millis();
+        _state = SAMPLER_SAMPLING;
+        break;
+
+    case SAMPLER_SAMPLING:
+    {
+        bool ready = true;
+        for (unsigned char i = 0; i < SOIL_SAMPLER_SENSORS; i++)
+            if (!_adc->ready(_sensors[i]->pin())) ready = false;
+        if (!ready && millis() - _since < SOIL_SAMPLE_TIMEOUT) return;
+
+        if (ready)
+        {
+            for (unsigned char i = 0; i < SOIL_SAMPLER_SENSORS; i++)
+                if (_sensors[i]->due()) _sensors[i]->sample(_adc->read(_sensors[i]->pin()));
+            _cycles++;
+        }
+        else
+        {
+            _errors++;
+            Serial.print(F("Soil sampler: no ADC data, errors: "));
+            Serial.println(_errors);
+        }
+        _power(false);
+        _state = SAMPLER_IDLE;
+        break;
+    }
+    }
+}
+
+inline unsigned short SoilSampler::settleTime(const unsigned short* time)
+{
+    if (time) _settle_time = *time;
+    return _settle_time;
+}
+
+inline unsigned long SoilSampler::cycles() { return _cycles; }
+
+void SoilSampler::wrapperUpdate(const void* context)
+{
+    SoilSampler* obj = (SoilSampler*)context;
+    obj->update();
+}
+
+unsigned short SoilSampler::wrapperSettleTime(const void* context, const unsigned short* time)
+{
+    SoilSampler* obj = (SoilSampler*)context;
+    return obj->settleTime(time);
+}
@@ -1,12 +1,14 @@
 #pragma once
 
-#include <ArduinoSTL.h>
-
 #include "SoilSensorState.hpp"
 #include "DataTypes.hpp"
+#include "AdcScanner.hpp"
+#include "HysteresisQuantizer.hpp"
+#include "Observers.hpp"
+
+#define SOIL_OBSERVERS 3 // processor, display, influx
 
-#define V_REF 500.0
-#define ADC_STEPS 1023.0
+static_assert(SOIL_ADC_MAX == ADC_SCAN_MAX, "soil boundaries are scaled to AdcScanner readings");
 
 using SoilCallback = void (*)(const void *, const unsigned char *, const SoilSensorState *);
 
@@ -15,78 +17,82 @@ class SoilSensor
 private:
     const ConfigUShort _delay_cf = {wrapperReadDelay, 100, 60000, 50, "ms"};
     const ConfigUChar _hysteresis_cf = {wrapperHysteresis, 0, 40, 1, "V/100"};
+    const ConfigUShort _threshold_cf[SOIL_LEVELS - 1] = {
+        {wrapperThreshold<0>, 0, V_REF, 5, "V/100"},
+        {wrapperThreshold<1>, 0, V_REF, 5, "V/100"},
+        {wrapperThreshold<2>, 0, V_REF, 5, "V/100"},
+        {wrapperThreshold<3>, 0, V_REF, 5, "V/100"}};
     // parameters
     unsigned char _id;
-    unsigned char _enPin;
     unsigned char _sensorPin;
     unsigned char _hysteresis = 10;
     unsigned long _last_read = 0;
     unsigned short _read_delay = 2000; // ms
     SoilSensorState _soilState;
-    std::vector<std::pair<const void *, SoilCallback>> _callbacks;
+    short _thresholds[SOIL_LEVELS - 1]; // readings (0..ADC_SCAN_MAX)
+    HysteresisQuantizer<SOIL_LEVELS - 1> _quantizer;
+    Observers<SoilCallback, SOIL_OBSERVERS> _callbacks;
     // functions
-    void setEN_Pin(bool state);
     void setAndCall(SoilSensorState s);
 
 public:
     const DataConfig delayConfig = {TYPE_USHORT, {.confUShort = &_delay_cf}};
     const DataConfig hysteresisConfig = {TYPE_UCHAR, {.confUChar = &_hysteresis_cf}};
+    const DataConfig thresholdConfig[SOIL_LEVELS - 1] = {
+        {TYPE_USHORT, {.confUShort = &_threshold_cf[0]}},
+        {TYPE_USHORT, {.confUShort = &_threshold_cf[1]}},
+        {TYPE_USHORT, {.confUShort = &_threshold_cf[2]}},
+        {TYPE_USHORT, {.confUShort = &_threshold_cf[3]}}};
 
     // functions
-    SoilSensor(unsigned char enPin, unsigned char sensorPin, unsigned char id);
+    SoilSensor(unsigned char sensorPin, unsigned char id);
     void addCallback(const void *context, SoilCallback valueChagedCallback);
     void Init();
 
     unsigned short readDelay(const unsigned short *delay);
     unsigned char hysteresis(const unsigned char *hys);
+    unsigned short threshold(unsigned char index, const unsigned short *value);
 
     SoilSensorState getLastState();
-    void readSensor();
+    unsigned char pin();
+    bool due();
+    void sample(unsigned short raw);
 
     static unsigned short wrapperReadDelay(const void *context, const unsigned short *delay);
     static unsigned char wrapperHysteresis(const void *context, const unsigned char *hys);
+    template <unsigned char I>
+    static unsigned short wrapperThreshold(const void *context, const unsigned short *value);
 };
 
-inline void SoilSensor::setEN_Pin(bool state)
-{
-    if (digitalRead(_enPin) != state)
-        digitalWrite(_enPin, state);
-}
-
 inline void SoilSensor::setAndCall(SoilSensorState s)
 {
     if(_soilState == s) return;
     _soilState = s;
 
-    for (const auto &callback : _callbacks)
-    {
-        callback.second(callback.first, &_id, &_soilState);
-    }
-    Serial.print("Soil sensor ");
+    _callbacks.notify(&_id, &_soilState);
+    Serial.print(F("Soil sensor "));
     Serial.print(_id);
-    Serial.print(" state changed to ");
+    Serial.print(F(" state changed to "));
     Serial.println(_soilState);
 }
 
-SoilSensor::SoilSensor(unsigned char enPin, unsigned char sensorPin, unsigned char id)
+SoilSensor::SoilSensor(unsigned char sensorPin, unsigned char id) : _quantizer(_thresholds, SOIL_COUNTS(_hysteresis))
 {
-    _enPin = enPin;
+    memcpy(_thresholds, soilThresholdCounts, sizeof(_thresholds));
     _sensorPin = sensorPin;
     _id = id;
 }
 
 void SoilSensor::addCallback(const void *context, SoilCallback valueChagedCallback)
 {
-    _callbacks.push_back(std::make_pair(context, valueChagedCallback));
+    _callbacks.add(context, valueChagedCallback);
 }
 
 inline void SoilSensor::Init()
 {
-    pinMode(_enPin, OUTPUT);
-    setEN_Pin(false);
-    Serial.print("Soil sensor ");
+    Serial.print(F("Soil sensor "));
     Serial.print(_id);
-    Serial.println(" initialized");
+    Serial.println(F(" initialized"));
 }
 
 inline unsigned short SoilSensor::readDelay(const unsigned short *delay)
@@ -104,103 +110,52 @@ inline unsigned char SoilSensor::hysteresis(const unsigned char *hys)
     if (hys)
     {
         _hysteresis = *hys;
+        _quantizer.band(SOIL_COUNTS(_hysteresis));
         return 0;
     }
     return _hysteresis;
 }
 
-inline SoilSensorState SoilSensor::getLastState() { return _soilState; }
-
-void SoilSensor::readSensor()
+// Boundary index (0 between SOIL_E_WET and SOIL_WET) of this probe, in V/100. The table stays sorted: moving a
+// boundary past its neighbours takes them along, so settings loaded in any order end up as saved.
+unsigned short SoilSensor::threshold(unsigned char index, const unsigned short *value)
 {
-    if (millis() - _last_read >= _read_delay)
+    if (value)
     {
-        short value = ((float)analogRead(_sensorPin) / ADC_STEPS) * V_REF;
-        /*Serial.print("Soil sensor ");
-        Serial.print(_id);
-        Serial.print(" read value: ");
-        Serial.print(value);
-        Serial.print(" pin: ");
-        Serial.println(_sensorPin);*/
-
-        switch (_soilState)
-        {
-        case SOIL_E_WET:
-        {
-            if (value >= SOIL_E_DRY + _hysteresis)
-                setAndCall(SOIL_E_DRY);
-            else if (value >= SOIL_DRY + _hysteresis)
-                setAndCall(SOIL_DRY);
-            else if (value >= SOIL_MOIST + _hysteresis)
-                setAndCall(SOIL_MOIST);
-            else if (value >= SOIL_WET + _hysteresis)
-                setAndCall(SOIL_WET);
-        }
-        case SOIL_WET:
-        {
-            if (value >= SOIL_E_DRY + _hysteresis)
-                setAndCall(SOIL_E_DRY);
-            else if (value >= SOIL_DRY + _hysteresis)
-                setAndCall(SOIL_DRY);
-            else if (value >= SOIL_MOIST + _hysteresis)
-                setAndCall(SOIL_MOIST);
-            else if (value <= SOIL_E_WET - _hysteresis)
-                setAndCall(SOIL_E_WET);
-            break;
-        }
-        case SOIL_MOIST:
-        {
-            if (value <= SOIL_E_WET - _hysteresis)
-                setAndCall(SOIL_E_WET);
-            else if (value <= SOIL_WET - _hysteresis)
-                setAndCall(SOIL_WET);
-            else if (value >= SOIL_DRY + _hysteresis)
-                setAndCall(SOIL_DRY);
-            else if (value >= SOIL_E_DRY + _hysteresis)
-                setAndCall(SOIL_E_DRY);
-            break;
-        }
-        case SOIL_DRY:
-        {
-            if (value >= SOIL_E_DRY + _hysteresis)
-                setAndCall(SOIL_E_DRY);
-            else if (value <= SOIL_E_WET - _hysteresis)
-                setAndCall(SOIL_E_WET);
-            else if (value <= SOIL_WET - _hysteresis)
-                setAndCall(SOIL_WET);
-            else if (value <= SOIL_MOIST - _hysteresis)
-                setAndCall(SOIL_MOIST);
-            break;
-        }
-        case SOIL_E_DRY:
+        short v = SOIL_COUNTS(*value);
+        _thresholds[index] = v;
+        for (unsigned char i = 0; i < index; i++)
         {
-            if (value <= SOIL_E_WET - _hysteresis)
-                setAndCall(SOIL_E_WET);
-            else if (value <= SOIL_WET - _hysteresis)
-                setAndCall(SOIL_WET);
-            else if (value <= SOIL_MOIST - _hysteresis)
-                setAndCall(SOIL_MOIST);
-            else if (value <= SOIL_DRY - _hysteresis)
-                setAndCall(SOIL_DRY);
-            break;
+            if (_thresholds[i] > v) _thresholds[i] = v;
         }
-        case UNINITIALIZED:
+        for (unsigned char i = index + 1; i < SOIL_LEVELS - 1; i++)
         {
-            if (value > SOIL_E_DRY - _hysteresis)
-                setAndCall(SOIL_E_DRY);
-            else if (value > SOIL_DRY - _hysteresis)
-                setAndCall(SOIL_DRY);
-            else if (value > SOIL_MOIST - _hysteresis)
-                setAndCall(SOIL_MOIST);
-            else if (value > SOIL_WET - _hysteresis)
-                setAndCall(SOIL_WET);
-            else
-                setAndCall(SOIL_E_WET);
-            break;
-        }
+            if (_thresholds[i] < v) _thresholds[i] = v;
         }
-        _last_read = millis();
+        _quantizer.reset();
+        return 0;
     }
+    return SOIL_VOLTS(_thresholds[index]);
+}
+
+inline SoilSensorState SoilSensor::getLastState() { return _soilState; }
+
+inline unsigned char SoilSensor::pin() { return _sensorPin; }
+
+inline bool SoilSensor::due() { return millis() - _last_read >= _read_delay; }
+
+// Called by SoilSampler with a fresh oversampled reading taken while the probe was powered.
+void SoilSensor::sample(unsigned short raw)
+{
+    /*Serial.print("Soil sensor ");
+    Serial.print(_id);
+    Serial.print(" read value: ");
+    Serial.print(SOIL_VOLTS(raw));
+    Serial.print(" pin: ");
+    Serial.println(_sensorPin);*/
+
+    setAndCall(soilLevelStates[_quantizer.update(raw)]);
+    _last_read = millis();
 }
 
 unsigned short SoilSensor::wrapperReadDelay(const void *context, const unsigned short *delay)
@@ -216,3 +171,11 @@ inline unsigned char SoilSensor::wrapperHysteresis(const void *context, const un
 
     return obj->hysteresis(hys);
 }
+
+template <unsigned char I>
+unsigned short SoilSensor::wrapperThreshold(const void *context, const unsigned short *value)
+{
+    SoilSensor *obj = (SoilSensor *)context;
+
+    return obj->threshold(I, value);
+}
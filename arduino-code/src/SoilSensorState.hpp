@@ -7,4 +7,18 @@ enum SoilSensorState{
     SOIL_MOIST = 290,
     SOIL_DRY = 330,
     SOIL_E_DRY = 370
-};
\ No newline at end of file
+};
+
+#define SOIL_LEVELS 5
+#define V_REF 500          // V/100
+#define SOIL_ADC_MAX 4092  // reading at V_REF, the AdcScanner full scale (ADC_SCAN_MAX)
+
+// V/100 to readings and back, rounded. Readings are compared as they come, so the scaling is
+// done once per setting instead of once per sample.
+#define SOIL_COUNTS(v) (short)(((long)(v) * SOIL_ADC_MAX + V_REF / 2) / V_REF)
+#define SOIL_VOLTS(counts) (short)(((long)(counts) * V_REF + SOIL_ADC_MAX / 2) / SOIL_ADC_MAX)
+
+// states in quantizer level order, default boundaries halfway between neighbouring states
+// (230, 270, 310, 350 V/100), every probe starts from this table and can move its own boundaries
+const SoilSensorState soilLevelStates[SOIL_LEVELS] = {SOIL_E_WET, SOIL_WET, SOIL_MOIST, SOIL_DRY, SOIL_E_DRY};
+const short soilThresholdCounts[SOIL_LEVELS - 1] = {SOIL_COUNTS(230), SOIL_COUNTS(270), SOIL_COUNTS(310), SOIL_COUNTS(350)};
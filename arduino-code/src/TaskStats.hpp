@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define TASK_STATS_BUCKETS 16 // bucket i counts runs of [2^i, 2^(i+1)) us, the last one is open ended
+
+// Run-time statistics of one task, fixed size so the whole table is known at link time.
+struct TaskStats
+{
+    unsigned long min_us;
+    unsigned long max_us;
+    unsigned long sum_us;
+    unsigned long count;
+    unsigned short hist[TASK_STATS_BUCKETS];
+
+    void reset();
+    void record(unsigned long us);
+    unsigned long mean();
+    void print(Print* out, const __FlashStringHelper* name);
+};
+
+inline void TaskStats::reset()
+{
+    memset(this, 0, sizeof(TaskStats));
+    min_us = 0xFFFFFFFF;
+}
+
+void TaskStats::record(unsigned long us)
+{
+    if (us < min_us) min_us = us;
+    if (us > max_us) max_us = us;
+    if (sum_us + us < sum_us) // halve both so the mean survives the overflow
+    {
+        sum_us >>= 1;
+        count >>= 1;
+    }
+    sum_us += us;
+    count++;
+
+    unsigned char bucket = 0;
+    while ((us >>= 1) && bucket < TASK_STATS_BUCKETS - 1) bucket++;
+    if (hist[bucket] != 0xFFFF) hist[bucket]++;
+}
+
+inline unsigned long TaskStats::mean() { return count ? sum_us / count : 0; }
+
+void TaskStats::print(Print* out, const __FlashStringHelper* name)
+{
+    out->print(name);
+    out->print(F(" n="));
+    out->print(count);
+    out->print(F(" min="));
+    out->print(count ? min_us : 0);
+    out->print(F(" avg="));
+    out->print(mean());
+    out->print(F(" max="));
+    out->print(max_us);
+    out->print(F(" us hist:"));
+    for (unsigned char i = 0; i < TASK_STATS_BUCKETS; i++)
+    {
+        out->print(' ');
+        out->print(hist[i]);
+    }
+}
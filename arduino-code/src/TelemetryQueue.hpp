@@ -0,0 +1,360 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "EepromLayout.hpp"
+#include "Fixed.hpp"
+#include "SoilSensorState.hpp"
+
+#define TELEMETRY_RECORD 11       // bytes per point, see _pack()
+#define TELEMETRY_RAM_POINTS 32   // SRAM ring
+#define TELEMETRY_EEPROM_POINTS (EEPROM_TELEMETRY_SIZE / TELEMETRY_RECORD) // 93 on the Mega
+#define TELEMETRY_NO_TIME 0xFFFF  // record delta of a point without timestamp
+#define TELEMETRY_TEMP_OFFSET CENTI(40) // packed temperatures start at -40 C
+#define TELEMETRY_PACKED_NAN 0x0FFF
+
+static_assert(TELEMETRY_RAM_POINTS <= 255 && TELEMETRY_EEPROM_POINTS <= 255, "ring indexes are bytes");
+
+// One sample. time 0: the RTC had no valid time, the server stamps it.
+struct TelemetryPoint
+{
+    unsigned long time; //s since 1970 UTC
+    Centi tempIn;
+    Centi tempOut;
+    Centi humIn;
+    Centi humOut;
+    short soil[3];
+    unsigned char water;
+    unsigned char light;
+};
+
+struct TelemetryCounters
+{
+    unsigned long queued;
+    unsigned long dropped;
+    unsigned long replayed;   // sent after a failed POST or while the link was down
+    unsigned long spilled;    // moved to EEPROM
+    unsigned short peak;      // most points waiting at once
+};
+
+// Points waiting for upload, oldest first. Each one is a fixed 11 byte record: seconds since the
+// previous stamped point, the DHT values in 12 bits each (0.1 steps, all the DHT11 resolves), the
+// three soil states as one base-6 digit triple, water and light level.
+// New records go to the SRAM ring; when it is full its oldest record moves on to an EEPROM ring
+// (written a byte per update(), like the settings) and only when both are full is the oldest point
+// dropped. The EEPROM part does not survive a reset, it only stretches the outage that fits.
+// read() walks the deltas from the oldest record, so it is meant for the first few points.
+class TelemetryQueue
+{
+private:
+    unsigned char _ram[TELEMETRY_RAM_POINTS][TELEMETRY_RECORD];
+    unsigned char _ram_head = 0;
+    unsigned char _ram_count = 0;
+    unsigned char _eeprom_head = 0;
+    unsigned char _eeprom_count = 0;
+    unsigned char _spill[TELEMETRY_RECORD]; // record being written to EEPROM
+    unsigned char _spill_slot = 0;
+    unsigned char _spill_written = TELEMETRY_RECORD;
+    unsigned long _base = 0;        // time the oldest record's delta counts from
+    unsigned long _newest_time = 0; // of the newest stamped record
+    unsigned short _stamped = 0;
+    unsigned short _held = 0;       // oldest points that must stay in place (POST under way)
+    unsigned short _delayed = 0;    // oldest points counted as replayed once sent
+    TelemetryCounters _counters = {0, 0, 0, 0, 0};
+
+    static unsigned char* _address(unsigned char slot);
+    static unsigned short _delta(const unsigned char* record);
+    static void _pack(const TelemetryPoint& point, unsigned short delta, unsigned char* record);
+    static void _unpack(const unsigned char* record, TelemetryPoint* point);
+    static unsigned short _packCenti(Centi value, Centi offset);
+    static Centi _unpackCenti(unsigned short value, Centi offset);
+    void _record(unsigned short index, unsigned char* record);
+    void _removeOldest(bool sent);
+    void _spillOldest();
+
+public:
+    void Init();
+    unsigned short count();
+    bool push(const TelemetryPoint& point, bool delayed);
+    bool read(unsigned short index, TelemetryPoint* point);
+    bool newestStamped();
+    void hold(unsigned short count);
+    void remove(unsigned short count);
+    void markDelayed();
+    void update();
+    const TelemetryCounters& counters();
+    void printStatus(Print* out);
+
+    static void wrapperUpdate(const void* context);
+    static void wrapperCommand(const void* context, Print* out, const char* args);
+};
+
+inline void TelemetryQueue::Init()
+{
+    Serial.println(F("Telemetry queue initialized"));
+}
+
+inline unsigned short TelemetryQueue::count() { return _eeprom_count + _ram_count; }
+
+inline unsigned char* TelemetryQueue::_address(unsigned char slot)
+{
+    return (unsigned char*)(uintptr_t)(EEPROM_TELEMETRY_START + (unsigned short)slot * TELEMETRY_RECORD);
+}
+
+inline unsigned short TelemetryQueue::_delta(const unsigned char* record) { return record[0] | (record[1] << 8); }
+
+// Centi in 0.1 steps from offset, TELEMETRY_PACKED_NAN for no reading, out of range values clamped
+unsigned short TelemetryQueue::_packCenti(Centi value, Centi offset)
+{
+    if (!centiValid(value)) return TELEMETRY_PACKED_NAN;
+    long packed = ((long)value - offset) / 10;
+    if (packed < 0) return 0;
+    if (packed >= TELEMETRY_PACKED_NAN) return TELEMETRY_PACKED_NAN - 1;
+    return packed;
+}
+
+inline Centi TelemetryQueue::_unpackCenti(unsigned short value, Centi offset)
+{
+    return (value == TELEMETRY_PACKED_NAN) ? CENTI_NAN : (Centi)(value * 10 + offset);
+}
+
+// delta (2), tempIn|tempOut (3), humIn|humOut (3), soil (1), water (1), light (1)
+void TelemetryQueue::_pack(const TelemetryPoint& point, unsigned short delta, unsigned char* record)
+{
+    unsigned short values[4] = {
+        _packCenti(point.tempIn, -TELEMETRY_TEMP_OFFSET), _packCenti(point.tempOut, -TELEMETRY_TEMP_OFFSET),
+        _packCenti(point.humIn, 0), _packCenti(point.humOut, 0)};
+    record[0] = delta & 0xFF;
+    record[1] = delta >> 8;
+    for (unsigned char i = 0; i < 4; i += 2)
+    {
+        unsigned char* out = record + 2 + i / 2 * 3;
+        out[0] = values[i] & 0xFF;
+        out[1] = (values[i] >> 8) | ((values[i + 1] & 0x0F) << 4);
+        out[2] = values[i + 1] >> 4;
+    }
+    unsigned char soil = 0;
+    for (unsigned char i = 3; i-- > 0;)
+    {
+        unsigned char level = 0; // 0 for UNINITIALIZED, then soilLevelStates + 1
+        for (unsigned char j = 0; j < SOIL_LEVELS; j++)
+        {
+            if (point.soil[i] == soilLevelStates[j]) level = j + 1;
+        }
+        soil = soil * (SOIL_LEVELS + 1) + level;
+    }
+    record[8] = soil;
+    record[9] = point.water;
+    record[10] = point.light;
+}
+
+void TelemetryQueue::_unpack(const unsigned char* record, TelemetryPoint* point)
+{
+    unsigned short values[4];
+    for (unsigned char i = 0; i < 4; i += 2)
+    {
+        const unsigned char* in = record + 2 + i / 2 * 3;
+        values[i] = in[0] | ((in[1] & 0x0F) << 8);
+        values[i + 1] = (in[1] >> 4) | (in[2] << 4);
+    }
+    point->tempIn = _unpackCenti(values[0], -TELEMETRY_TEMP_OFFSET);
+    point->tempOut = _unpackCenti(values[1], -TELEMETRY_TEMP_OFFSET);
+    point->humIn = _unpackCenti(values[2], 0);
+    point->humOut = _unpackCenti(values[3], 0);
+    unsigned char soil = record[8];
+    for (unsigned char i = 0; i < 3; i++)
+    {
+        unsigned char level = soil % (SOIL_LEVELS + 1);
+        soil /= SOIL_LEVELS + 1;
+        point->soil[i] = level ? soilLevelStates[level - 1] : UNINITIALIZED;
+    }
+    point->water = record[9];
+    point->light = record[10];
+}
+
+// index counts from the oldest point: the EEPROM ring first, then SRAM
+void TelemetryQueue::_record(unsigned short index, unsigned char* record)
+{
+    if (index < _eeprom_count)
+    {
+        unsigned short slot = _eeprom_head + index;
+        if (slot >= TELEMETRY_EEPROM_POINTS) slot -= TELEMETRY_EEPROM_POINTS;
+        if (_spill_written < TELEMETRY_RECORD && slot == _spill_slot) memcpy(record, _spill, TELEMETRY_RECORD);
+        else eeprom_read_block(record, _address(slot), TELEMETRY_RECORD);
+        return;
+    }
+    unsigned short slot = _ram_head + index - _eeprom_count;
+    if (slot >= TELEMETRY_RAM_POINTS) slot -= TELEMETRY_RAM_POINTS;
+    memcpy(record, _ram[slot], TELEMETRY_RECORD);
+}
+
+void TelemetryQueue::_removeOldest(bool sent)
+{
+    unsigned char record[TELEMETRY_RECORD];
+    _record(0, record);
+    unsigned short delta = _delta(record);
+    if (delta != TELEMETRY_NO_TIME)
+    {
+        _base += delta;
+        if (--_stamped == 0) _newest_time = 0;
+    }
+    if (_eeprom_count)
+    {
+        if (_spill_written < TELEMETRY_RECORD && _eeprom_head == _spill_slot) _spill_written = TELEMETRY_RECORD;
+        if (++_eeprom_head >= TELEMETRY_EEPROM_POINTS) _eeprom_head = 0;
+        _eeprom_count--;
+    }
+    else
+    {
+        if (++_ram_head >= TELEMETRY_RAM_POINTS) _ram_head = 0;
+        _ram_count--;
+    }
+    if (_delayed)
+    {
+        _delayed--;
+        if (sent) _counters.replayed++;
+    }
+}
+
+// Oldest SRAM record to the end of the EEPROM ring, which has room and no record still being written
+void TelemetryQueue::_spillOldest()
+{
+    unsigned short slot = _eeprom_head + _eeprom_count;
+    if (slot >= TELEMETRY_EEPROM_POINTS) slot -= TELEMETRY_EEPROM_POINTS;
+    memcpy(_spill, _ram[_ram_head], TELEMETRY_RECORD);
+    _spill_slot = slot;
+    _spill_written = 0;
+    _eeprom_count++;
+    if (++_ram_head >= TELEMETRY_RAM_POINTS) _ram_head = 0;
+    _ram_count--;
+    _counters.spilled++;
+}
+
+// Queues a sample, delayed when it cannot go out on time (link down, last POST failed).
+// With no room the oldest point goes, or the new one if the oldest are being sent or the
+// previous spill is still being written (points are a log period apart, so hardly ever).
+bool TelemetryQueue::push(const TelemetryPoint& point, bool delayed)
+{
+    if (_ram_count == TELEMETRY_RAM_POINTS)
+    {
+        if (_spill_written < TELEMETRY_RECORD)
+        {
+            _counters.dropped++;
+            return false;
+        }
+        if (_eeprom_count == TELEMETRY_EEPROM_POINTS)
+        {
+            _counters.dropped++;
+            if (_held) return false;
+            _removeOldest(false);
+        }
+        if (_ram_count == TELEMETRY_RAM_POINTS) _spillOldest();
+    }
+    unsigned short delta = TELEMETRY_NO_TIME;
+    if (point.time)
+    {
+        if (!_stamped)
+        {
+            _base = point.time;
+            delta = 0;
+        }
+        else if (point.time - _newest_time < TELEMETRY_NO_TIME) delta = point.time - _newest_time;
+        // else the clock was set back or jumped over 18 h: the point goes without timestamp
+        if (delta != TELEMETRY_NO_TIME)
+        {
+            _newest_time = point.time;
+            _stamped++;
+        }
+    }
+    unsigned short slot = _ram_head + _ram_count;
+    if (slot >= TELEMETRY_RAM_POINTS) slot -= TELEMETRY_RAM_POINTS;
+    _pack(point, delta, _ram[slot]);
+    _ram_count++;
+    _counters.queued++;
+    if (delayed) _delayed = count();
+    if (count() > _counters.peak) _counters.peak = count();
+    return true;
+}
+
+bool TelemetryQueue::read(unsigned short index, TelemetryPoint* point)
+{
+    if (index >= count()) return false;
+    unsigned char record[TELEMETRY_RECORD];
+    unsigned long time = _base;
+    unsigned short delta = TELEMETRY_NO_TIME;
+    for (unsigned short i = 0; i <= index; i++)
+    {
+        _record(i, record);
+        delta = _delta(record);
+        if (delta != TELEMETRY_NO_TIME) time += delta;
+    }
+    _unpack(record, point);
+    point->time = (delta != TELEMETRY_NO_TIME) ? time : 0;
+    return true;
+}
+
+// false also for an empty queue; the newest point is always in SRAM
+bool TelemetryQueue::newestStamped()
+{
+    if (!_ram_count) return false;
+    unsigned short slot = _ram_head + _ram_count - 1;
+    if (slot >= TELEMETRY_RAM_POINTS) slot -= TELEMETRY_RAM_POINTS;
+    return _delta(_ram[slot]) != TELEMETRY_NO_TIME;
+}
+
+// The oldest count points keep their place until remove() or hold(0)
+inline void TelemetryQueue::hold(unsigned short count) { _held = count; }
+
+// The oldest count points were delivered
+void TelemetryQueue::remove(unsigned short count)
+{
+    _held = 0;
+    while (count-- && this->count()) _removeOldest(true);
+}
+
+// Everything queued now missed its upload
+inline void TelemetryQueue::markDelayed() { _delayed = count(); }
+
+// One byte of the spilled record per run, whenever the EEPROM is ready
+void TelemetryQueue::update()
+{
+    if (_spill_written >= TELEMETRY_RECORD || !eeprom_is_ready()) return;
+    eeprom_update_byte(_address(_spill_slot) + _spill_written, _spill[_spill_written]);
+    _spill_written++;
+}
+
+inline const TelemetryCounters& TelemetryQueue::counters() { return _counters; }
+
+void TelemetryQueue::printStatus(Print* out)
+{
+    out->print(F("queued="));
+    out->print(_counters.queued);
+    out->print(F(" replayed="));
+    out->print(_counters.replayed);
+    out->print(F(" dropped="));
+    out->print(_counters.dropped);
+    out->print(F(" spilled="));
+    out->print(_counters.spilled);
+    out->print(F(" waiting="));
+    out->print(count());
+    out->print('/');
+    out->print(TELEMETRY_RAM_POINTS + TELEMETRY_EEPROM_POINTS);
+    out->print(F(" eeprom="));
+    out->print(_eeprom_count);
+    out->print(F(" peak="));
+    out->println(_counters.peak);
+}
+
+void TelemetryQueue::wrapperUpdate(const void* context)
+{
+    TelemetryQueue* obj = (TelemetryQueue*)context;
+    obj->update();
+}
+
+// "queue" shows the counters, "queue reset" clears them
+void TelemetryQueue::wrapperCommand(const void* context, Print* out, const char* args)
+{
+    TelemetryQueue* obj = (TelemetryQueue*)context;
+    if (strcmp_P(args, PSTR("reset")) == 0) obj->_counters = {0, 0, 0, 0, obj->count()};
+    obj->printStatus(out);
+}
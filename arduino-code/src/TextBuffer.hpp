@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Fixed.hpp"
+
+// Text assembled in a fixed char array that is part of the owner (or the stack), for labels and
+// values drawn on the display. Nothing is allocated, whatever does not fit is cut off.
+//   TextBuffer<6> time;
+//   time.number(hours, 2).put(':').number(minutes, 2); // "07:05"
+template <unsigned char N>
+class TextBuffer
+{
+private:
+    char _buf[N];
+    unsigned char _len = 0;
+
+public:
+    TextBuffer();
+    TextBuffer& clear();
+    TextBuffer& put(char c);
+    TextBuffer& text(const char* str);
+    TextBuffer& textP(PGM_P str);
+    TextBuffer& number(long value, unsigned char width = 0);
+    TextBuffer& centi(Centi value, unsigned char decimals);
+    TextBuffer& unit(const char* unit);
+
+    const char* c_str() const;
+    unsigned char length() const;
+};
+
+template <unsigned char N>
+TextBuffer<N>::TextBuffer() { _buf[0] = '\0'; }
+
+template <unsigned char N>
+inline TextBuffer<N>& TextBuffer<N>::clear()
+{
+    _len = 0;
+    _buf[0] = '\0';
+    return *this;
+}
+
+template <unsigned char N>
+inline TextBuffer<N>& TextBuffer<N>::put(char c)
+{
+    if (_len < N - 1)
+    {
+        _buf[_len++] = c;
+        _buf[_len] = '\0';
+    }
+    return *this;
+}
+
+template <unsigned char N>
+TextBuffer<N>& TextBuffer<N>::text(const char* str)
+{
+    while (*str) put(*str++);
+    return *this;
+}
+
+// str in flash (PROGMEM)
+template <unsigned char N>
+TextBuffer<N>& TextBuffer<N>::textP(PGM_P str)
+{
+    char c;
+    while ((c = pgm_read_byte(str++))) put(c);
+    return *this;
+}
+
+// Decimal, zero padded on the left to at least width digits.
+template <unsigned char N>
+TextBuffer<N>& TextBuffer<N>::number(long value, unsigned char width)
+{
+    char tmp[11]; // 2^32 has 10 digits
+    unsigned char len = 0;
+    unsigned long magnitude = (value < 0) ? -(unsigned long)value : value;
+    do
+    {
+        tmp[len++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) put('-');
+    while (width > len)
+    {
+        put('0');
+        width--;
+    }
+    while (len) put(tmp[--len]);
+    return *this;
+}
+
+template <unsigned char N>
+TextBuffer<N>& TextBuffer<N>::centi(Centi value, unsigned char decimals)
+{
+    char num[CENTI_FORMAT_LENGTH];
+    return text(formatCenti(num, value, decimals));
+}
+
+// " unit", nothing for an empty one
+template <unsigned char N>
+inline TextBuffer<N>& TextBuffer<N>::unit(const char* unit)
+{
+    if (unit[0] != '\0') put(' ').text(unit);
+    return *this;
+}
+
+template <unsigned char N>
+inline const char* TextBuffer<N>::c_str() const { return _buf; }
+
+template <unsigned char N>
+inline unsigned char TextBuffer<N>::length() const { return _len; }
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <util/twi.h>
+#else
+#include <Wire.h>
+#endif
+
+#define TWI_QUEUE_LENGTH 4
+#define TWI_FREQUENCY 100000L //Hz
+#define TWI_TIMEOUT_MS 20 //ms, a 12 byte read takes ~1.3 ms at 100 kHz
+
+enum TwiStatus
+{
+    TWI_QUEUED,
+    TWI_BUSY,
+    TWI_OK,
+    TWI_NACK,
+    TWI_BUS_ERROR,
+    TWI_TIMEOUT,
+    TWI_QUEUE_FULL
+};
+
+// One master read, owned by the caller and valid until status leaves TWI_QUEUED/TWI_BUSY.
+struct TwiRequest
+{
+    unsigned char address;
+    unsigned char* data;
+    unsigned char length;
+    volatile unsigned char received;
+    volatile TwiStatus status;
+};
+
+struct TwiCounters
+{
+    unsigned long done;
+    unsigned long nacks;
+    unsigned long busErrors;
+    unsigned long timeouts;
+};
+
+// Interrupt driven I2C master. Queued reads run back to back from TWI_vect, the caller only
+// polls request status, update() aborts a transaction stuck longer than TWI_TIMEOUT_MS.
+// Replaces Wire, which spins in requestFrom() and leaves the caller spinning on available().
+class TwiMaster
+{
+private:
+    TwiRequest* volatile _queue[TWI_QUEUE_LENGTH];
+    volatile unsigned char _head = 0;
+    volatile unsigned char _count = 0;
+    volatile unsigned long _started = 0; //ms
+    TwiCounters _counters = {0, 0, 0, 0};
+
+    void _startNext();
+    void _finish(TwiStatus status);
+    void _isr();
+
+    static TwiMaster* _instance;
+
+public:
+    TwiMaster();
+    void Init();
+    bool read(TwiRequest* request, unsigned char address, unsigned char* data, unsigned char length);
+    void update();
+    const TwiCounters& counters();
+    void printCounters(Print* out);
+
+    static void wrapperInterrupt();
+    static void wrapperUpdate(const void* context);
+    static void wrapperCountersCommand(const void* context, Print* out, const char* args);
+};
+
+TwiMaster* TwiMaster::_instance = nullptr;
+
+TwiMaster::TwiMaster() {}
+
+void TwiMaster::Init()
+{
+    _instance = this;
+#ifdef __AVR__
+    digitalWrite(SDA, HIGH); // internal pull-ups, same as Wire.begin()
+    digitalWrite(SCL, HIGH);
+    TWSR = 0;
+    TWBR = ((F_CPU / TWI_FREQUENCY) - 16) / 2;
+    TWCR = _BV(TWEN);
+#else
+    Wire.begin();
+#endif
+    Serial.println(F("TWI master initialized"));
+}
+
+// Queues a read of `length` bytes from `address` into `data`. False (and TWI_QUEUE_FULL) if there is no room.
+bool TwiMaster::read(TwiRequest* request, unsigned char address, unsigned char* data, unsigned char length)
+{
+    if (_count >= TWI_QUEUE_LENGTH)
+    {
+        request->status = TWI_QUEUE_FULL;
+        return false;
+    }
+    request->address = address;
+    request->data = data;
+    request->length = length;
+    request->received = 0;
+    request->status = TWI_QUEUED;
+
+    noInterrupts();
+    _queue[(_head + _count) % TWI_QUEUE_LENGTH] = request;
+    _count++;
+    bool idle = (_count == 1);
+    interrupts();
+
+    if (idle) _startNext();
+    return true;
+}
+
+// Issues START for the queue head. On AVR called with the bus idle, either from read() or
+// chained from the ISR after the previous STOP.
+void TwiMaster::_startNext()
+{
+    if (!_count) return;
+    _queue[_head]->status = TWI_BUSY;
+    _started = millis();
+#ifdef __AVR__
+    TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWINT) | _BV(TWSTA);
+#endif
+}
+
+void TwiMaster::_finish(TwiStatus status)
+{
+    TwiRequest* request = _queue[_head];
+    request->status = status;
+    switch (status)
+    {
+        case TWI_OK: _counters.done++; break;
+        case TWI_NACK: _counters.nacks++; break;
+        case TWI_BUS_ERROR: _counters.busErrors++; break;
+        case TWI_TIMEOUT: _counters.timeouts++; break;
+        default: break;
+    }
+    _head = (_head + 1) % TWI_QUEUE_LENGTH;
+    _count--;
+}
+
+#ifdef __AVR__
+void TwiMaster::_isr()
+{
+    if (!_count) // nothing queued (aborted by a timeout), release the bus
+    {
+        TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+        return;
+    }
+    TwiRequest* request = _queue[_head];
+    const unsigned char ack = _BV(TWEN) | _BV(TWIE) | _BV(TWINT) | _BV(TWEA);
+    const unsigned char nack = _BV(TWEN) | _BV(TWIE) | _BV(TWINT);
+    TwiStatus result = TWI_BUSY;
+
+    switch (TW_STATUS)
+    {
+        case TW_START:
+        case TW_REP_START:
+            TWDR = (request->address << 1) | TW_READ;
+            TWCR = nack;
+            return;
+        case TW_MR_SLA_ACK:
+            TWCR = (request->length > 1) ? ack : nack;
+            return;
+        case TW_MR_DATA_ACK:
+            request->data[request->received++] = TWDR;
+            TWCR = (request->received < request->length - 1) ? ack : nack;
+            return;
+        case TW_MR_DATA_NACK:
+            request->data[request->received++] = TWDR;
+            result = TWI_OK;
+            break;
+        case TW_MR_SLA_NACK:
+            result = TWI_NACK;
+            break;
+        case TW_MR_ARB_LOST:
+            _finish(TWI_BUS_ERROR);
+            TWCR = _BV(TWEN) | _BV(TWINT); // bus is someone else's, no STOP
+            return;
+        default: // TW_BUS_ERROR and anything unexpected
+            result = TWI_BUS_ERROR;
+            break;
+    }
+
+    _finish(result);
+    if (_count)
+    {
+        // STOP followed by START of the next queued read in one write
+        _queue[_head]->status = TWI_BUSY;
+        _started = millis();
+        TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWINT) | _BV(TWSTO) | _BV(TWSTA);
+    }
+    else TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+}
+
+ISR(TWI_vect) { TwiMaster::wrapperInterrupt(); }
+#else
+// No TWI hardware on the host: the transfer happens here, as if the interrupt had fired.
+void TwiMaster::_isr()
+{
+    if (!_count) return;
+    TwiRequest* request = _queue[_head];
+    unsigned char received = Wire.requestFrom(request->address, request->length);
+    for (unsigned char i = 0; i < received; i++) request->data[i] = Wire.read();
+    request->received = received;
+    _finish(received == request->length ? TWI_OK : TWI_NACK);
+    _startNext();
+}
+#endif
+
+// Run from the scheduler. Aborts a transaction that did not finish in TWI_TIMEOUT_MS
+// (slave holding SCL, lost interrupt) and moves on to the next one.
+void TwiMaster::update()
+{
+#ifndef __AVR__
+    while (_count) _isr();
+#endif
+    noInterrupts();
+    bool stuck = _count && millis() - _started >= TWI_TIMEOUT_MS;
+    if (stuck)
+    {
+#ifdef __AVR__
+        TWCR = 0; // reset the peripheral, it lets go of SDA/SCL
+        TWCR = _BV(TWEN);
+#endif
+        _finish(TWI_TIMEOUT);
+    }
+    interrupts();
+    if (stuck) _startNext();
+}
+
+inline const TwiCounters& TwiMaster::counters() { return _counters; }
+
+void TwiMaster::printCounters(Print* out)
+{
+    out->print(F("twi ok="));
+    out->print(_counters.done);
+    out->print(F(" nack="));
+    out->print(_counters.nacks);
+    out->print(F(" bus_err="));
+    out->print(_counters.busErrors);
+    out->print(F(" timeout="));
+    out->println(_counters.timeouts);
+}
+
+void TwiMaster::wrapperInterrupt()
+{
+    if (_instance) _instance->_isr();
+}
+
+void TwiMaster::wrapperUpdate(const void* context)
+{
+    TwiMaster* obj = (TwiMaster*)context;
+    obj->update();
+}
+
+void TwiMaster::wrapperCountersCommand(const void* context, Print* out, const char* args)
+{
+    (void)args;
+    TwiMaster* obj = (TwiMaster*)context;
+    obj->printCounters(out);
+}
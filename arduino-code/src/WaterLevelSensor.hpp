@@ -1,14 +1,17 @@
 #pragma once
 
-#include <ArduinoSTL.h>
-#include <Wire.h>
+#include "TwiMaster.hpp"
+#include "HysteresisQuantizer.hpp"
+#include "Observers.hpp"
 
 #include "DataTypes.hpp"
 
 #define NO_TOUCH       0xFE
 #define THRESHOLD      100
+#define PAD_HYSTERESIS 10
 #define ATTINY1_HIGH_ADDR   0x78
 #define ATTINY2_LOW_ADDR   0x77
+#define WATER_OBSERVERS 3 // processor, display, influx
 
 using WaterLevelCallback = void (*)(const void*, const unsigned char*);
 
@@ -21,99 +24,106 @@ private:
     unsigned char _low_data[8] = {0};
     unsigned char _high_data[12] = {0};
     unsigned char _waterLevel = 0; //%
+    unsigned long _wet_pads = 0; // bit per pad (low section first), each with its own hysteresis
     unsigned long _last_read = 0;
     unsigned short _read_delay = 2000; //ms
+    unsigned long _read_errors = 0;
+    bool _reading = false;
 
-    std::vector<std::pair<const void*, WaterLevelCallback>> _callbacks;
+    TwiMaster* _twi = nullptr;
+    TwiRequest _low_request;
+    TwiRequest _high_request;
 
-    void getHigh12SectionValue();
-    void getLow8SectionValue();
+    Observers<WaterLevelCallback, WATER_OBSERVERS> _callbacks;
+
+    void _decode();
 
 public:
     const DataConfig delayConfig = {TYPE_USHORT, {.confUShort = &_delay_cf}};
 
     WaterLevelSensor();
     void readSensor();
-    void Init();
+    void Init(TwiMaster* twi);
     void addCallback(const void *context, WaterLevelCallback valueChagedCallback);
 
     unsigned short readDelay(const unsigned short* delay);
 
     unsigned char getWaterLevel();
     unsigned short getReadDelay();
+    unsigned long getReadErrors();
     
+    static void wrapperReadSensor(const void* context);
     static unsigned short wrapperReadDelay(const void* context, const unsigned short* delay);
 };
 
-inline void WaterLevelSensor::getHigh12SectionValue()
+WaterLevelSensor::WaterLevelSensor() {}
+
+// Both section reads are queued together and run back to back in the background,
+// the level is decoded only once both ATtinys answered.
+void WaterLevelSensor::readSensor()
 {
-    memset(_high_data, 0, sizeof(_high_data));
-    Wire.requestFrom(ATTINY1_HIGH_ADDR, 12);
-    while (12 != Wire.available());
-    for (unsigned char i = 0; i < 12; i++) {_high_data[i] = Wire.read();}
+    if(!_reading)
+    {
+        if(millis() - _last_read < _read_delay + 10000UL) return;
+        _twi->read(&_low_request, ATTINY2_LOW_ADDR, _low_data, sizeof(_low_data));
+        _twi->read(&_high_request, ATTINY1_HIGH_ADDR, _high_data, sizeof(_high_data));
+        _reading = true;
+        return;
+    }
+
+    if(_low_request.status <= TWI_BUSY || _high_request.status <= TWI_BUSY) return;
+    _reading = false;
+    _last_read = millis();
+
+    if(_low_request.status != TWI_OK || _high_request.status != TWI_OK)
+    {
+        _read_errors++;
+        Serial.print(F("Water level read failed, status: "));
+        Serial.print(_low_request.status);
+        Serial.print('/');
+        Serial.print(_high_request.status);
+        Serial.print(F(" errors: "));
+        Serial.println(_read_errors);
+        return;
+    }
+    _decode();
 }
 
-inline void WaterLevelSensor::getLow8SectionValue()
+void WaterLevelSensor::_decode()
 {
-    memset(_low_data, 0, sizeof(_low_data));
-    Wire.requestFrom(ATTINY2_LOW_ADDR, 8);
-    while (8 != Wire.available());
-    for (unsigned char i = 0; i < 8 ; i++) {_low_data[i] = Wire.read();}
-    
-}
+    static const short threshold = THRESHOLD;
+    unsigned char trig_section = 0;
 
-WaterLevelSensor::WaterLevelSensor() {}
+    for (unsigned char i = 0 ; i < 20; i++) {
+        unsigned char value = (i < 8) ? _low_data[i] : _high_data[i - 8];
+        unsigned char wet = HysteresisQuantizer<1>::step(&threshold, PAD_HYSTERESIS, bitRead(_wet_pads, i), value);
+        bitWrite(_wet_pads, i, wet);
+    }
+    unsigned long touch_val = _wet_pads;
 
-void WaterLevelSensor::readSensor()
-{
-    if(millis() - _last_read >= _read_delay + 10000)
+    while (touch_val & 0x01)
+    {
+        trig_section++;
+        touch_val >>= 1;
+    }
+    if(trig_section * 5 != _waterLevel)
     {
+        _waterLevel = trig_section * 5;
+        _callbacks.notify(&_waterLevel);
+        Serial.print(F("Water level changed to: "));
         Serial.println(_waterLevel);
-        unsigned int touch_val = 0;
-        unsigned char trig_section = 0;
-        getLow8SectionValue();
-        getHigh12SectionValue();
-
-        for (unsigned char i = 0 ; i < 8; i++) {
-            if (_low_data[i] > THRESHOLD) {
-                touch_val |= 1 << i;
-
-            }
-        }
-        for (unsigned char i = 0 ; i < 12; i++) {
-            if (_high_data[i] > THRESHOLD) {
-                touch_val |= (uint32_t)1 << (8 + i);
-            }
-        }
-
-        while (touch_val & 0x01)
-        {
-            trig_section++;
-            touch_val >>= 1;
-        }
-        if(trig_section * 5 != _waterLevel)
-        {
-            _waterLevel = trig_section * 5;
-            for (const auto& callback : _callbacks)
-            {
-                callback.second(callback.first, &_waterLevel);
-            }
-            Serial.print("Water level changed to: ");
-            Serial.println(_waterLevel);
-        }
-        _last_read = millis();
     }
 }
 
-inline void WaterLevelSensor::Init() 
+inline void WaterLevelSensor::Init(TwiMaster* twi)
 {
-    Wire.begin();
-    Serial.print("Water level sensor initialized");
+    _twi = twi;
+    Serial.print(F("Water level sensor initialized"));
 }
 
 void WaterLevelSensor::addCallback(const void *context, WaterLevelCallback valueChagedCallback)
 {
-    _callbacks.push_back(std::make_pair(context, valueChagedCallback));
+    _callbacks.add(context, valueChagedCallback);
 }
 
 inline unsigned short WaterLevelSensor::readDelay(const unsigned short *delay)
@@ -126,6 +136,14 @@ inline unsigned char WaterLevelSensor::getWaterLevel() { return _waterLevel; }
 
 inline unsigned short WaterLevelSensor::getReadDelay() { return _read_delay; }
 
+inline unsigned long WaterLevelSensor::getReadErrors() { return _read_errors; }
+
+void WaterLevelSensor::wrapperReadSensor(const void *context)
+{
+    WaterLevelSensor* obj = (WaterLevelSensor*)context;
+    obj->readSensor();
+}
+
 unsigned short WaterLevelSensor::wrapperReadDelay(const void *context, const unsigned short *delay)
 {
     WaterLevelSensor* obj = (WaterLevelSensor*)context;
@@ -1,8 +1,16 @@
 #include <Arduino.h>
 #include <avr/wdt.h>
 
+// one Scheduler slot per addTask() in setup(), checked there
+#ifdef __AVR__
+#define SCHEDULER_MAX_TASKS 16
+#else
+#define SCHEDULER_MAX_TASKS 17 // + adc, the ADC interrupt does its work on the board
+#endif
+
 #include "Enkoder.hpp"
 #include "SoilSensor.hpp"
+#include "SoilSampler.hpp"
 #include "DHTSensor.hpp"
 #include "WaterLevelSensor.hpp"
 #include "Relays.hpp"
@@ -10,22 +18,26 @@
 #include "Light.hpp"
 #include "Processor.hpp"
 #include "Disp.hpp"
+#include "HttpPost.hpp"
 #include "InfluxSender.hpp"
+#include "Scheduler.hpp"
+#include "TwiMaster.hpp"
+#include "AdcScanner.hpp"
+#include "SerialConsole.hpp"
+#include "EventQueue.hpp"
+#include "Params.hpp"
+#include "SettingsStore.hpp"
+#include "TelemetryQueue.hpp"
 
 #define VERSION "1.0.1"
 
-#define ENCODER_CLK_PIN 3
-#define ENCODER_DT_PIN 34
-#define ENCODER_SW_PIN 2
 #define DTH11_IN_PIN 32
 #define DTH11_OUT_PIN 33
 #define SOIL_SENSOR_1_PIN A0
 #define SOIL_SENSOR_2_PIN A1
 #define SOIL_SENSOR_3_PIN A2
 #define SOIL_SENSOR_EN_PIN 35
-#define LED_R_PIN 41
-#define LED_G_PIN 39
-#define LED_B_PIN 40
+#define SOIL_SENSOR_EN_ACTIVE LOW // probes were always read with the pin held low
 #define LIGHT_SENSOR_PIN A3
 #define RTC_CLK 38
 #define RTC_DAT 37
@@ -43,57 +55,170 @@
 #define INFLUX_MEASUREMENT "dane"
 #define INFLUX_LOG_PERIOD 60000
 
+// scheduler periods, modules still apply their own read delays on top of these
+#define ENCODER_TASK_PERIOD 5 //ms
+#define RELAYS_TASK_PERIOD 10 //ms
+#define TWI_TASK_PERIOD 10 //ms, only checks for timeouts on the board
+#define SENSOR_TASK_PERIOD 100 //ms
+#define SOIL_TASK_PERIOD 10 //ms, resolution of the probe settle time
+#define DHT_TASK_PERIOD 20 //ms, also sets the length of the DHT11 start pulse
+#define PROCESSOR_TASK_PERIOD 100 //ms
+#define EVENTS_TASK_PERIOD 10 //ms, upper bound of the sensor -> relay reaction time
+#define DISP_TASK_PERIOD 10 //ms, one page of a frame per run
+#define INFLUX_TASK_PERIOD 1000 //ms
+#define HTTP_TASK_PERIOD 10 //ms, one step of a request per run
+#define CONSOLE_TASK_PERIOD 50 //ms
+#define SETTINGS_TASK_PERIOD 5 //ms, one EEPROM byte per run at most
+#define TELEMETRY_TASK_PERIOD 5 //ms, one byte of a spilled point per run at most
+
 
-Enkoder enkoder(ENCODER_CLK_PIN, ENCODER_DT_PIN, ENCODER_SW_PIN);
-SoilSensor soilSensor1(SOIL_SENSOR_EN_PIN, SOIL_SENSOR_1_PIN, 0);
-SoilSensor soilSensor2(SOIL_SENSOR_EN_PIN, SOIL_SENSOR_2_PIN, 1);
-SoilSensor soilSensor3(SOIL_SENSOR_EN_PIN, SOIL_SENSOR_3_PIN, 2);
+Enkoder enkoder;
+SoilSensor soilSensor1(SOIL_SENSOR_1_PIN, 0);
+SoilSensor soilSensor2(SOIL_SENSOR_2_PIN, 1);
+SoilSensor soilSensor3(SOIL_SENSOR_3_PIN, 2);
+SoilSampler soilSampler(SOIL_SENSOR_EN_PIN, SOIL_SENSOR_EN_ACTIVE);
 DHTSensor dhtIn(DTH11_IN_PIN);
 DHTSensor dhtOut(DTH11_OUT_PIN);
+AdcScanner adc;
+TwiMaster twi;
 WaterLevelSensor waterLevelSensor;
 Relays relays;
 virtuabotixRTC myRTC(RTC_CLK, RTC_DAT, RTC_RST);
 Disp disp(OLED_CS, OLED_RES, OLED_DC);
-Light light(LIGHT_SENSOR_PIN, LED_R_PIN, LED_G_PIN, LED_B_PIN);
+Light light(LIGHT_SENSOR_PIN);
 Processor processor;
-InfluxSender influxSender(INFLUX_SSID, INFLUX_PASSWORD, INFLUX_HOST, INFLUX_PORT, INFLUX_DB_NAME, INFLUX_MEASUREMENT, INFLUX_LOG_PERIOD, VERSION);
+EventQueue events;
+HttpPost http(INFLUX_HOST, INFLUX_PORT);
+TelemetryQueue telemetry;
+InfluxSender influxSender(INFLUX_SSID, INFLUX_PASSWORD, INFLUX_DB_NAME, INFLUX_MEASUREMENT, INFLUX_LOG_PERIOD, VERSION);
+Scheduler scheduler;
+SerialConsole console(VERSION);
+ParamRegistry paramRegistry;
+SettingsStore settings;
+
+// every setting, in MenuID order; keys are persisted with the values, never reuse or renumber one
+const Param params[] PROGMEM = {
+  PARAM(ACTUATOR, relays, actuatorConfig, PARAM_NOT_STORED, PARAM_LIVE, "actuator"),
+  PARAM(LED, relays, ledConfig, PARAM_NOT_STORED, PARAM_LIVE, "led"),
+  PARAM(PUMP, relays, pumpConfig, PARAM_NOT_STORED, PARAM_LIVE, "pump"),
+  PARAM(HEATER, relays, heaterConfig, PARAM_NOT_STORED, PARAM_LIVE, "heater"),
+  PARAM(SWITCHING_DELAY, relays, relayDelayConfig, 1, 0, "relay_delay"),
+  PARAM(SWITCHING_OFF_DELAY, relays, relayOffDelayConfig, 2, 0, "relay_off_delay"),
+  PARAM(TEMP_SETPOINT, processor, tempSetpointConfig, 3, 0, "temp_set"),
+  PARAM(TEMP_HYS, processor, tempHysConfig, 4, 0, "temp_hys"),
+  PARAM(HUM_SETPOINT, processor, humSetpointConfig, 5, 0, "hum_set"),
+  PARAM(HUM_HYS, processor, humHysConfig, 6, 0, "hum_hys"),
+  PARAM(PUMP_SENSOR_COUNT, processor, pumpSensorActiveCountConfig, 7, 0, "pump_sensors"),
+  PARAM(PUMP_SETPOINT, processor, pumpSetpointConfig, 8, 0, "pump_set"),
+  PARAM(PUMP_RUN_TIME, processor, pumpRunTimeConfig, 9, 0, "pump_time"),
+  PARAM(PUMP_RUN_INTERVAL, processor, pumpRunIntervalConfig, 10, 0, "pump_interval"),
+  PARAM(LED_THRESHOLD, processor, ledTresholdConfig, 11, 0, "led_threshold"),
+  PARAM(LED_HYS, processor, ledHysConfig, 12, 0, "led_hys"),
+  PARAM(LED_RUN_TIME, processor, ledRunTimeConfig, 13, 0, "led_time"),
+  PARAM(LED_RUN_INTERVAL, processor, ledRunIntervalConfig, 14, 0, "led_interval"),
+  PARAM(DISPLAY_BRIGHTNESS, disp, brightnessConfig, 15, 0, "disp_bright"),
+  PARAM(DISPLAY_SAVER_BRIGHTNESS, disp, blankingBrightnessConfig, 16, 0, "saver_bright"),
+  PARAM(DISPLAY_SAVER_TIME, disp, blankingTimeConfig, 17, 0, "saver_time"),
+  PARAM(DISPLAY_SWITCH_TIME, disp, screanSwitchTimeConfig, 18, 0, "disp_switch"),
+  PARAM(SENSORS_SOIL1_DELAY, soilSensor1, delayConfig, 19, 0, "soil1_delay"),
+  PARAM(SENSORS_SOIL1_HYS, soilSensor1, hysteresisConfig, 20, 0, "soil1_hys"),
+  PARAM(SENSORS_SOIL1_T1, soilSensor1, thresholdConfig[0], 36, 0, "soil1_t1"),
+  PARAM(SENSORS_SOIL1_T2, soilSensor1, thresholdConfig[1], 37, 0, "soil1_t2"),
+  PARAM(SENSORS_SOIL1_T3, soilSensor1, thresholdConfig[2], 38, 0, "soil1_t3"),
+  PARAM(SENSORS_SOIL1_T4, soilSensor1, thresholdConfig[3], 39, 0, "soil1_t4"),
+  PARAM(SENSORS_SOIL2_DELAY, soilSensor2, delayConfig, 21, 0, "soil2_delay"),
+  PARAM(SENSORS_SOIL2_HYS, soilSensor2, hysteresisConfig, 22, 0, "soil2_hys"),
+  PARAM(SENSORS_SOIL2_T1, soilSensor2, thresholdConfig[0], 40, 0, "soil2_t1"),
+  PARAM(SENSORS_SOIL2_T2, soilSensor2, thresholdConfig[1], 41, 0, "soil2_t2"),
+  PARAM(SENSORS_SOIL2_T3, soilSensor2, thresholdConfig[2], 42, 0, "soil2_t3"),
+  PARAM(SENSORS_SOIL2_T4, soilSensor2, thresholdConfig[3], 43, 0, "soil2_t4"),
+  PARAM(SENSORS_SOIL3_DELAY, soilSensor3, delayConfig, 23, 0, "soil3_delay"),
+  PARAM(SENSORS_SOIL3_HYS, soilSensor3, hysteresisConfig, 24, 0, "soil3_hys"),
+  PARAM(SENSORS_SOIL3_T1, soilSensor3, thresholdConfig[0], 44, 0, "soil3_t1"),
+  PARAM(SENSORS_SOIL3_T2, soilSensor3, thresholdConfig[1], 45, 0, "soil3_t2"),
+  PARAM(SENSORS_SOIL3_T3, soilSensor3, thresholdConfig[2], 46, 0, "soil3_t3"),
+  PARAM(SENSORS_SOIL3_T4, soilSensor3, thresholdConfig[3], 47, 0, "soil3_t4"),
+  PARAM(SENSORS_SOIL_SETTLE, soilSampler, settleConfig, 25, 0, "soil_settle"),
+  PARAM(SENSORS_DHT_IN, dhtIn, delayConfig, 26, 0, "dht_in_delay"),
+  PARAM(SENSORS_DHT_IN_TEMP_BAND, dhtIn, tempBandConfig, 27, 0, "dht_in_band_t"),
+  PARAM(SENSORS_DHT_IN_HUM_BAND, dhtIn, humBandConfig, 28, 0, "dht_in_band_h"),
+  PARAM(SENSORS_DHT_IN_INTERVAL, dhtIn, notifyIntervalConfig, 29, 0, "dht_in_notify"),
+  PARAM(SENSORS_DHT_OUT, dhtOut, delayConfig, 30, 0, "dht_out_delay"),
+  PARAM(SENSORS_DHT_OUT_TEMP_BAND, dhtOut, tempBandConfig, 31, 0, "dht_out_band_t"),
+  PARAM(SENSORS_DHT_OUT_HUM_BAND, dhtOut, humBandConfig, 32, 0, "dht_out_band_h"),
+  PARAM(SENSORS_DHT_OUT_INTERVAL, dhtOut, notifyIntervalConfig, 33, 0, "dht_out_notify"),
+  PARAM(SENSORS_WATER, waterLevelSensor, delayConfig, 34, 0, "water_delay"),
+  PARAM(SENSORS_PHOTO, light, delayConfig, 35, 0, "light_delay"),
+};
+static_assert(ITEM_COUNT(params) == MENU_ID_COUNT - 1, "every MenuID needs its PARAM() entry");
 
 
 void setup() {
   Serial.begin(115200);
   Serial1.begin(115200);
   enkoder.Init();
+  adc.Init();
   soilSensor1.Init();
   soilSensor2.Init();
   soilSensor3.Init();
-  waterLevelSensor.Init();
+  soilSampler.Init(&adc, &soilSensor1, &soilSensor2, &soilSensor3);
+  twi.Init();
+  waterLevelSensor.Init(&twi);
   dhtIn.Init();
   dhtOut.Init();
   relays.Init();
-  light.Init();
-  disp.Init(&dhtIn, &dhtOut, &soilSensor1, &soilSensor2, &soilSensor3, &waterLevelSensor, &light, &relays, &enkoder, &myRTC, &processor);
-  processor.Init(&dhtIn, &dhtOut, &soilSensor1, &soilSensor2, &soilSensor3, &waterLevelSensor, &light, &relays);
-  influxSender.Init(&Serial1, &dhtIn, &dhtOut, &soilSensor1, &soilSensor2, &soilSensor3, &waterLevelSensor, &light);
+  light.Init(&adc);
+  paramRegistry.Init(params, ITEM_COUNT(params));
+  disp.Init(&dhtIn, &dhtOut, &soilSensor1, &soilSensor2, &soilSensor3, &waterLevelSensor, &light, &relays, &enkoder, &myRTC, &paramRegistry);
+  processor.Init(&dhtIn, &dhtOut, &soilSensor1, &soilSensor2, &soilSensor3, &waterLevelSensor, &light, &relays, &events);
+  http.Init(&Serial1);
+  telemetry.Init();
+  influxSender.Init(&Serial1, &http, &telemetry, &myRTC, &dhtIn, &dhtOut, &soilSensor1, &soilSensor2, &soilSensor3, &waterLevelSensor, &light);
+  settings.Init(&paramRegistry); // after every module, the saved values override their defaults
+
+  // same order as the old poll loop, sensor tasks are staggered so they do not pile up in one pass
+  scheduler.addTask(F("enkoder"), &enkoder, Enkoder::wrapperLoop, ENCODER_TASK_PERIOD);
+#ifndef __AVR__
+  scheduler.addTask(F("adc"), &adc, AdcScanner::wrapperUpdate, SENSOR_TASK_PERIOD); // on the board the ADC interrupt does this
+#endif
+  scheduler.addTask(F("soil"), &soilSampler, SoilSampler::wrapperUpdate, SOIL_TASK_PERIOD);
+  scheduler.addTask(F("water"), &waterLevelSensor, WaterLevelSensor::wrapperReadSensor, SENSOR_TASK_PERIOD, 30);
+  scheduler.addTask(F("twi"), &twi, TwiMaster::wrapperUpdate, TWI_TASK_PERIOD);
+  scheduler.addTask(F("dht_in"), &dhtIn, DHTSensor::wrapperReadSensor, DHT_TASK_PERIOD, 40);
+  scheduler.addTask(F("dht_out"), &dhtOut, DHTSensor::wrapperReadSensor, DHT_TASK_PERIOD, 50);
+  scheduler.addTask(F("relays"), &relays, Relays::wrapperUpdate, RELAYS_TASK_PERIOD);
+  scheduler.addTask(F("light"), &light, Light::wrapperUpdate, SENSOR_TASK_PERIOD, 60);
+  scheduler.addTask(F("events"), &events, EventQueue::wrapperDispatch, EVENTS_TASK_PERIOD, 5);
+  scheduler.addTask(F("processor"), &processor, Processor::wrapperUpdate, PROCESSOR_TASK_PERIOD, 70);
+  scheduler.addTask(F("disp"), &disp, Disp::wrapperUpdate, DISP_TASK_PERIOD);
+  scheduler.addTask(F("influx"), &influxSender, InfluxSender::wrapperUpdate, INFLUX_TASK_PERIOD, 80);
+  scheduler.addTask(F("http"), &http, HttpPost::wrapperUpdate, HTTP_TASK_PERIOD, 3);
+  scheduler.addTask(F("console"), &console, SerialConsole::wrapperUpdate, CONSOLE_TASK_PERIOD);
+  scheduler.addTask(F("settings"), &settings, SettingsStore::wrapperUpdate, SETTINGS_TASK_PERIOD);
+  scheduler.addTask(F("telemetry"), &telemetry, TelemetryQueue::wrapperUpdate, TELEMETRY_TASK_PERIOD, 2);
+  if (scheduler.taskCount() != SCHEDULER_MAX_TASKS) Serial.println(F("Scheduler: SCHEDULER_MAX_TASKS does not match the tasks"));
+
+  console.Init(&Serial);
+  console.addCommand(F("stats"), &scheduler, Scheduler::wrapperStatsCommand);
+  console.addCommand(F("twi"), &twi, TwiMaster::wrapperCountersCommand);
+  console.addCommand(F("events"), &events, EventQueue::wrapperStatsCommand);
+  console.addCommand(F("dht_in"), &dhtIn, DHTSensor::wrapperStatusCommand);
+  console.addCommand(F("dht_out"), &dhtOut, DHTSensor::wrapperStatusCommand);
+  console.addCommand(F("relays"), &relays, Relays::wrapperStatusCommand);
+  console.addCommand(F("disp"), &disp, Disp::wrapperStatsCommand);
+  console.addCommand(F("param"), &paramRegistry, ParamRegistry::wrapperCommand);
+  console.addCommand(F("settings"), &settings, SettingsStore::wrapperCommand);
+  console.addCommand(F("wifi"), &influxSender, InfluxSender::wrapperStatusCommand);
+  console.addCommand(F("http"), &http, HttpPost::wrapperCountersCommand);
+  console.addCommand(F("queue"), &telemetry, TelemetryQueue::wrapperCommand);
 }
 
 void loop() {
-  enkoder.loop();
-  soilSensor1.readSensor();
-  soilSensor2.readSensor();
-  soilSensor3.readSensor();
-  waterLevelSensor.readSensor();
-  dhtIn.readSensor();
-  dhtOut.readSensor();
-  relays.update();
-  light.update();
-  processor.update();
-  disp.update();
-  influxSender.Update();
+  scheduler.run();
 }
 
 /*
 TODO LIST:
- - Dodać zapisywanie ustawień do EEPROM
  - Dodać możliwość zmiany czasu
  - Dodać możliwość ustwanienia czasu w którym działa LED
 */
\ No newline at end of file